@@ -0,0 +1,131 @@
+// 前进/后退栈的微基准：不同容量下每次导航的开销
+// 每种容量先压满，再重复执行固定的操作序列（压入并淘汰、后退两步后压入截断前进部分、偶尔按 id 删除），
+// 环形缓冲区的每次操作开销应与容量无关；对照组是改造前的 QList 实现（mid 截断、removeFirst 淘汰）
+//
+// 用法：navigationstack_bench [每种容量的操作数]
+
+#include "navigationstack.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QList>
+
+using namespace WinBrowserQt;
+
+namespace {
+
+// 改造前 NavigationManager 中的实现，只保留与栈有关的部分
+class LegacyStack
+{
+public:
+    explicit LegacyStack(int capacity) : m_capacity(capacity) {}
+
+    void push(const HistoryItem &item)
+    {
+        if (m_current < m_history.size() - 1) {
+            m_history = m_history.mid(0, m_current + 1);
+        }
+        m_history.append(item);
+        if (m_history.size() > m_capacity) {
+            m_history.removeFirst();
+        } else {
+            m_current++;
+        }
+    }
+
+    void goBack()
+    {
+        if (m_current > 0) {
+            m_current--;
+        }
+    }
+
+    bool remove(const QString &id)
+    {
+        for (qsizetype i = 0; i < m_history.size(); ++i) {
+            if (m_history[i].id() == id) {
+                m_history.removeAt(i);
+                if (m_current >= i) {
+                    m_current = qMax<qsizetype>(0, m_current - 1);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    QList<HistoryItem> m_history;
+    qsizetype m_current = -1;
+    qsizetype m_capacity;
+};
+
+QList<HistoryItem> makeItems(int count)
+{
+    QList<HistoryItem> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        HistoryItem item;
+        item.setId(QString::number(i));
+        item.setUrl(QString("https://example.com/page/%1").arg(i));
+        item.setTitle(QString("页面 %1").arg(i));
+        items.append(item);
+    }
+    return items;
+}
+
+// 每 8 次操作：5 次压入、一次后退两步后压入（截断前进部分）、一次按 id 删除较早的条目
+template <typename Stack>
+double nsPerOperation(Stack &stack, const QList<HistoryItem> &items, int capacity, int operations)
+{
+    for (int i = 0; i < capacity; ++i) {
+        stack.push(items[i % items.size()]);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    int next = capacity;
+    for (int op = 0; op < operations; ++op) {
+        switch (op % 8) {
+        case 5:
+            stack.goBack();
+            stack.goBack();
+            stack.push(items[next++ % items.size()]);
+            break;
+        case 6:
+            stack.remove(items[(next - capacity / 2) % items.size()].id());
+            break;
+        default:
+            stack.push(items[next++ % items.size()]);
+            break;
+        }
+    }
+    return double(timer.nsecsElapsed()) / operations;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const int operations = argc > 1 ? qMax(8, QString::fromLocal8Bit(argv[1]).toInt()) : 200000;
+    // 对照组每次操作 O(容量)，操作数限制在可以接受的时间内
+    const int legacyOperations = qMin(operations, 2000);
+    const QList<int> capacities = { 100, 1000, 10000, 100000, 1000000 };
+    const QList<HistoryItem> items = makeItems(capacities.last() + operations + 1);
+
+    QTextStream out(stdout);
+    out << "容量\t环形缓冲区 ns/次\tQList 实现 ns/次\n";
+    for (int capacity : capacities) {
+        NavigationStack ring(capacity);
+        const double ringNs = nsPerOperation(ring, items, capacity, operations);
+
+        LegacyStack legacy(capacity);
+        const double legacyNs = nsPerOperation(legacy, items, capacity, legacyOperations);
+
+        out << capacity << '\t' << QString::number(ringNs, 'f', 1) << "\t\t"
+            << QString::number(legacyNs, 'f', 1) << '\n';
+        out.flush();
+    }
+    return 0;
+}
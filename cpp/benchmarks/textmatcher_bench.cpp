@@ -0,0 +1,102 @@
+// TextMatcher 与改造前 toLower().contains() 的对比
+// 标题和 URL 由英文、中文片段随机拼接（固定种子，结果可重复），模拟中英混排的历史记录；
+// 对照组与改造前的 searchHistory 相同：查询串转小写一次，每条记录的 URL 和标题各转小写一次再查找
+//
+// 用法：textmatcher_bench [记录数]
+
+#include "textmatcher.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+
+using namespace WinBrowserQt;
+
+namespace {
+
+struct Record
+{
+    QString url;
+    QString title;
+};
+
+QList<Record> makeRecords(int count)
+{
+    const QStringList hosts = {
+        "github.com", "www.bing.com", "zhuanlan.zhihu.com", "doc.qt.io", "www.bilibili.com",
+        "stackoverflow.com", "news.qq.com", "en.wikipedia.org", "zh.wikipedia.org", "mail.163.com"
+    };
+    const QStringList words = {
+        "Qt", "QString", "Network", "Concurrent", "WebEngine", "Release Notes", "GitHub", "Issues",
+        "Pull Request", "C++17", "SIMD", "AVX2", "How to", "Windows", "Linux",
+        "知乎", "百度一下", "你就知道", "新闻", "哔哩哔哩", "有问题，就会有答案", "维基百科",
+        "自由的百科全书", "性能优化", "历史记录", "书签", "浏览器", "搜索", "下载", "设置"
+    };
+
+    QRandomGenerator random(20240501);
+    QList<Record> records;
+    records.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QString host = hosts[random.bounded(int(hosts.size()))];
+        QStringList titleWords;
+        const int wordCount = 3 + random.bounded(6);
+        for (int w = 0; w < wordCount; ++w) {
+            titleWords.append(words[random.bounded(int(words.size()))]);
+        }
+
+        Record record;
+        record.url = QString("https://%1/%2/%3?id=%4").arg(host, titleWords.first(),
+                                                          QString::number(random.generate(), 16)).arg(i);
+        record.title = titleWords.join(random.bounded(2) ? QStringLiteral(" - ") : QStringLiteral(" "));
+        records.append(record);
+    }
+    return records;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const int count = argc > 1 ? qMax(1, QString::fromLocal8Bit(argv[1]).toInt()) : 200000;
+    const QList<Record> records = makeRecords(count);
+    // 短查询、常见英文、中文、大小写混合、不存在的查询
+    const QStringList queries = { "qt", "github", "Network", "知乎", "性能优化", "CONCURRENT", "不存在的查询", "zzzq" };
+
+    QTextStream out(stdout);
+    out << "记录数 " << count << "，TextMatcher 实现 " << TextMatcher::kernelName() << '\n';
+    out << "查询\t\t命中\ttoLower().contains() ms\tTextMatcher ms\t加速\n";
+
+    for (const QString &query : queries) {
+        QElapsedTimer timer;
+
+        timer.start();
+        const QString lowerQuery = query.toLower();
+        int baselineHits = 0;
+        for (const Record &record : records) {
+            if (record.url.toLower().contains(lowerQuery) || record.title.toLower().contains(lowerQuery)) {
+                ++baselineHits;
+            }
+        }
+        const double baselineMs = timer.nsecsElapsed() / 1e6;
+
+        timer.restart();
+        const TextMatcher matcher(query);
+        int matcherHits = 0;
+        for (const Record &record : records) {
+            if (matcher.matches(record.url) || matcher.matches(record.title)) {
+                ++matcherHits;
+            }
+        }
+        const double matcherMs = timer.nsecsElapsed() / 1e6;
+
+        out << query << (query.size() < 8 ? "\t\t" : "\t") << matcherHits
+            << (matcherHits != baselineHits ? QString("（对照 %1）").arg(baselineHits) : QString())
+            << '\t' << QString::number(baselineMs, 'f', 2) << "\t\t\t"
+            << QString::number(matcherMs, 'f', 2) << "\t\t"
+            << QString::number(baselineMs / qMax(matcherMs, 1e-3), 'f', 1) << "x\n";
+        out.flush();
+    }
+    return 0;
+}
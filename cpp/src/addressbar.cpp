@@ -1,5 +1,7 @@
 
 #include "addressbar.h"
+#include "navigationmanager.h"
+#include "suggestiondelegate.h"
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QKeyEvent>
@@ -10,18 +12,40 @@
 #include <QScreen>
 #include <QGuiApplication>
 #include <QUuid>
+#include <QSet>
+#include <QDebug>
 
 namespace WinBrowserQt {
 
 AddressBar::AddressBar(QWidget *parent)
     : QWidget(parent)
+    , m_navigationManager(nullptr)
+    , m_inputGeneration(0)
+    , m_pendingRequestId(0)
+    , m_pendingGeneration(0)
+    , m_lastKeystrokeMs(-1)
+    , m_typingIntervalMs(MAX_DEBOUNCE_MS / DEBOUNCE_FACTOR)
+    , m_latencyPending(false)
     , m_selectedSuggestionIndex(-1)
     , m_isShowingSuggestions(false)
 {
+    m_inputClock.start();
     initializeUI();
     setupEventHandlers();
 }
 
+void AddressBar::setNavigationManager(NavigationManager *navigationManager)
+{
+    if (m_navigationManager) {
+        disconnect(m_navigationManager, nullptr, this, nullptr);
+    }
+    m_navigationManager = navigationManager;
+    if (m_navigationManager) {
+        connect(m_navigationManager, &NavigationManager::historySuggestionsReady,
+                this, &AddressBar::onHistorySuggestionsReady);
+    }
+}
+
 void AddressBar::initializeUI()
 {
     setMinimumHeight(35);
@@ -54,34 +78,56 @@ void AddressBar::initializeUI()
     panelLayout->setSpacing(0);
 
     // 建议列表
-    m_suggestionsList = new QListWidget(m_suggestionsPanel);
+    // 建议列表：模型直接持有建议数组，委托按统一行高绘制，只有可见的行会被绘制
+    m_suggestionsModel = new SuggestionListModel(this);
+    m_suggestionsList = new QListView(m_suggestionsPanel);
     m_suggestionsList->setFont(QFont("Segoe UI", 9));
     m_suggestionsList->setMaximumHeight(200);
     m_suggestionsList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_suggestionsList->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_suggestionsList->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_suggestionsList->setUniformItemSizes(true);
+    m_suggestionsList->setModel(m_suggestionsModel);
+    m_suggestionsList->setItemDelegate(new SuggestionDelegate(m_suggestionsList));
     panelLayout->addWidget(m_suggestionsList);
 
-    // 建议定时器
+    // 开销较大的建议来源的防抖定时器，间隔随输入节奏调整
     m_suggestionsTimer = new QTimer(this);
-    m_suggestionsTimer->setInterval(300);
     m_suggestionsTimer->setSingleShot(true);
 
     // 网络管理器
     m_networkManager = new QNetworkAccessManager(this);
+
+    // 远程搜索建议，防抖间隔比本地后台搜索更长
+    m_remoteSuggestions = new RemoteSuggestionProvider(m_networkManager, this);
+    m_remoteSuggestionsTimer = new QTimer(this);
+    m_remoteSuggestionsTimer->setSingleShot(true);
 }
 
 void AddressBar::setupEventHandlers()
 {
     m_addressTextBox->installEventFilter(this);
-    connect(m_addressTextBox, &QLineEdit::textChanged, this, &AddressBar::onTextChanged);
+    m_suggestionsList->viewport()->installEventFilter(this);
+    // 只有用户编辑才生成建议；setUrl 和选择建议时的 setText 不会触发
+    connect(m_addressTextBox, &QLineEdit::textEdited, this, &AddressBar::onTextEdited);
 
     connect(m_goButton, &QPushButton::clicked, this, &AddressBar::onGoButtonClicked);
-    connect(m_suggestionsList, &QListWidget::itemClicked, this, &AddressBar::onSuggestionSelected);
+    connect(m_suggestionsList, &QListView::clicked, this, &AddressBar::onSuggestionSelected);
 
     connect(m_suggestionsTimer, &QTimer::timeout, this, &AddressBar::onSuggestionsTimerTimeout);
+    connect(m_remoteSuggestionsTimer, &QTimer::timeout, this, &AddressBar::onRemoteSuggestionsTimerTimeout);
+    connect(m_remoteSuggestions, &RemoteSuggestionProvider::suggestionsReady,
+            this, &AddressBar::onRemoteSuggestionsReady);
 }
 
 bool AddressBar::eventFilter(QObject *watched, QEvent *event)
 {
+    if (watched == m_suggestionsList->viewport() && event->type() == QEvent::Paint && m_latencyPending) {
+        // 绘制事件在绘制前分发，列表本身的绘制很快，这里记录的即是结果上屏的时刻
+        m_latencyPending = false;
+        m_inputLatency.record(m_latencyClock.nsecsElapsed() / 1000);
+    }
+
     if (watched == m_addressTextBox) {
         if (event->type() == QEvent::KeyPress) {
             QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
@@ -107,6 +153,7 @@ bool AddressBar::eventFilter(QObject *watched, QEvent *event)
             m_addressTextBox->selectAll();
             showSuggestions();
         } else if (event->type() == QEvent::FocusOut) {
+            m_latencyPending = false;
             // 延迟隐藏建议，以便处理建议列表的点击事件
             QTimer::singleShot(100, this, [this]() {
                 if (!m_suggestionsList->hasFocus() && !m_suggestionsPanel->hasFocus()) {
@@ -127,9 +174,179 @@ void AddressBar::resizeEvent(QResizeEvent *event)
     }
 }
 
-void AddressBar::onTextChanged(const QString &text)
+void AddressBar::onTextEdited(const QString &text)
+{
+    // 只有在末尾继续输入时补全；删除或在中间编辑时保持原样，否则退格无法删掉补全的部分
+    const bool appended = text.size() > m_typedText.size() && text.startsWith(m_typedText)
+        && m_addressTextBox->cursorPosition() == text.size();
+    m_typedText = text;
+    if (appended) {
+        applyInlineCompletion(text);
+    }
+
+    // 旧输入的后台搜索已经没有意义，立即取消；本地来源立即更新，后台搜索等输入停顿
+    recordKeystroke();
+    ++m_inputGeneration;
+    cancelPendingSuggestions();
+    generateSuggestions(m_typedText);
+    m_suggestionsTimer->start(debounceInterval(DEBOUNCE_FACTOR, MIN_DEBOUNCE_MS, MAX_DEBOUNCE_MS));
+    if (m_remoteSuggestions->isEnabled()) {
+        m_remoteSuggestionsTimer->start(
+            debounceInterval(REMOTE_DEBOUNCE_FACTOR, MIN_REMOTE_DEBOUNCE_MS, MAX_REMOTE_DEBOUNCE_MS));
+    }
+}
+
+void AddressBar::recordKeystroke()
 {
-    m_suggestionsTimer->start();
+    m_latencyClock.start();
+    m_latencyPending = true;
+
+    const qint64 now = m_inputClock.elapsed();
+    if (m_lastKeystrokeMs >= 0 && now - m_lastKeystrokeMs < TYPING_PAUSE_MS) {
+        m_typingIntervalMs = 0.7 * m_typingIntervalMs + 0.3 * double(now - m_lastKeystrokeMs);
+    }
+    m_lastKeystrokeMs = now;
+}
+
+int AddressBar::debounceInterval(double factor, int minMs, int maxMs) const
+{
+    // 略长于平均按键间隔：连续输入时不发出请求，一停顿就发出；输入越快等待越短
+    return qBound(minMs, int(m_typingIntervalMs * factor), maxMs);
+}
+
+void AddressBar::logLatencyStats() const
+{
+    qInfo().noquote() << "地址栏按键到绘制延迟:" << m_inputLatency.summary()
+                      << QString("平均按键间隔 %1ms").arg(m_typingIntervalMs, 0, 'f', 0);
+}
+
+void AddressBar::applyInlineCompletion(const QString &typed)
+{
+    if (!m_navigationManager) {
+        return;
+    }
+    const QString completion = m_navigationManager->inlineCompletion(typed);
+    if (completion.isEmpty()) {
+        return;
+    }
+
+    // 补全的部分保持选中：继续输入会替换它，退格会删掉它，回车则接受
+    m_addressTextBox->setText(typed + completion);
+    m_addressTextBox->setSelection(typed.size(), completion.size());
+}
+
+void AddressBar::cancelPendingSuggestions()
+{
+    if (m_pendingRequestId != 0 && m_navigationManager) {
+        m_navigationManager->cancelHistorySuggestions();
+    }
+    m_pendingRequestId = 0;
+}
+
+void AddressBar::onHistorySuggestionsReady(quint64 requestId, const QString &, const QList<HistoryItem> &results)
+{
+    // 请求编号不符或发出请求后又有按键，都是过期的结果
+    if (requestId != m_pendingRequestId || m_pendingGeneration != m_inputGeneration) {
+        return;
+    }
+    m_pendingRequestId = 0;
+
+    // 前缀匹配已经显示，子串匹配补足剩余的名额
+    int historyCount = 0;
+    QSet<QString> seenUrls;
+    for (const auto &suggestion : std::as_const(m_suggestions)) {
+        if (suggestion.type == SuggestionType::History) {
+            ++historyCount;
+            seenUrls.insert(suggestion.url);
+        }
+    }
+    qsizetype insertAt = 0;
+    while (insertAt < m_suggestions.size() && m_suggestions[insertAt].type != SuggestionType::SearchSuggestion) {
+        ++insertAt;
+    }
+    bool added = false;
+    for (const auto &item : results) {
+        if (historyCount >= MAX_HISTORY_SUGGESTIONS) {
+            break;
+        }
+        if (seenUrls.contains(item.url())) {
+            continue;
+        }
+        SuggestionItem historySuggestion;
+        historySuggestion.type = SuggestionType::History;
+        historySuggestion.title = item.title();
+        historySuggestion.url = item.url();
+        m_suggestions.insert(insertAt++, historySuggestion);
+        seenUrls.insert(item.url());
+        ++historyCount;
+        added = true;
+    }
+
+    // 新增的行插在远程搜索建议之前，已有的行和当前选中项不变
+    if (added) {
+        updateSuggestionsList();
+        showSuggestions();
+    }
+}
+
+void AddressBar::setRemoteSuggestionEndpoint(const QString &urlTemplate)
+{
+    m_remoteSuggestions->setEndpoint(urlTemplate);
+}
+
+void AddressBar::onRemoteSuggestionsTimerTimeout()
+{
+    // 带协议的地址和本地地址不发给搜索引擎
+    const QString query = m_typedText.trimmed();
+    if (query.isEmpty() || query.contains(QLatin1String("://")) || isLocalOrPrivateAddress(query)) {
+        return;
+    }
+    m_remoteSuggestions->request(query);
+}
+
+void AddressBar::onRemoteSuggestionsReady(const QString &query, const QStringList &suggestions, bool)
+{
+    // 临时结果（来自更短前缀的缓存）与最终结果同样显示，最终结果到达时按差量替换；
+    // 只接受与当前输入一致的结果，用户正在用方向键选择时不改动列表
+    if (RemoteSuggestionProvider::normalizeQuery(query) != RemoteSuggestionProvider::normalizeQuery(m_typedText)
+        || m_selectedSuggestionIndex >= 0) {
+        return;
+    }
+    setRemoteSuggestions(suggestions);
+    if (!m_suggestions.isEmpty()) {
+        showSuggestions();
+    }
+}
+
+void AddressBar::setRemoteSuggestions(const QStringList &suggestions)
+{
+    m_suggestions.removeIf([](const SuggestionItem &item) {
+        return item.type == SuggestionType::SearchSuggestion;
+    });
+
+    const QString typed = RemoteSuggestionProvider::normalizeQuery(m_typedText);
+    int count = 0;
+    for (const QString &suggestion : suggestions) {
+        if (count >= MAX_REMOTE_SUGGESTIONS) {
+            break;
+        }
+        // 与输入相同的建议已经由第一项“搜索”覆盖
+        if (RemoteSuggestionProvider::normalizeQuery(suggestion) == typed) {
+            continue;
+        }
+        SuggestionItem item;
+        item.type = SuggestionType::SearchSuggestion;
+        item.title = suggestion;
+        item.url = searchUrlFor(suggestion);
+        m_suggestions.append(item);
+        ++count;
+    }
+    updateSuggestionsList();
+}
+
+QString AddressBar::searchUrlFor(const QString &term)
+{
+    return QString("https://www.bing.com/search?q=%1").arg(QString::fromUtf8(QUrl::toPercentEncoding(term)));
 }
 
 void AddressBar::onGoButtonClicked()
@@ -137,23 +354,26 @@ void AddressBar::onGoButtonClicked()
     navigate();
 }
 
-void AddressBar::onSuggestionSelected()
+void AddressBar::onSuggestionSelected(const QModelIndex &index)
 {
-    if (m_selectedSuggestionIndex >= 0 && m_selectedSuggestionIndex < m_suggestions.size()) {
-        m_addressTextBox->setText(m_suggestions[m_selectedSuggestionIndex].url);
+    if (index.isValid() && index.row() < m_suggestions.size()) {
+        const QString url = m_suggestions[index.row()].url;
+        m_addressTextBox->setText(url);
         hideSuggestions();
-        navigateTo(m_suggestions[m_selectedSuggestionIndex].url);
+        navigateTo(url);
     }
 }
 
 void AddressBar::onSuggestionsTimerTimeout()
 {
-    generateSuggestions(m_addressTextBox->text());
+    // 按用户输入的部分搜索，内联补全的部分不参与
+    requestHistorySuggestions(m_typedText);
 }
 
 void AddressBar::setUrl(const QString &url)
 {
     m_addressTextBox->setText(url);
+    m_typedText = url;
 }
 
 QString AddressBar::getUrl() const
@@ -170,16 +390,29 @@ void AddressBar::focusAddressBox()
 void AddressBar::clear()
 {
     m_addressTextBox->clear();
+    m_typedText.clear();
+    ++m_inputGeneration;
     hideSuggestions();
 }
 
 void AddressBar::generateSuggestions(const QString &input)
 {
     if (input.trimmed().isEmpty()) {
+        m_latencyPending = false;
         hideSuggestions();
         return;
     }
 
+    // 上一次的远程建议中仍以当前输入开头的先保留，等新的结果到达后替换，避免列表闪烁
+    QList<SuggestionItem> remoteSuggestions;
+    const QString typed = RemoteSuggestionProvider::normalizeQuery(input);
+    for (const auto &suggestion : std::as_const(m_suggestions)) {
+        if (suggestion.type == SuggestionType::SearchSuggestion
+            && RemoteSuggestionProvider::normalizeQuery(suggestion.title).startsWith(typed)) {
+            remoteSuggestions.append(suggestion);
+        }
+    }
+
     m_suggestions.clear();
 
     // 添加搜索建议
@@ -187,8 +420,7 @@ void AddressBar::generateSuggestions(const QString &input)
         SuggestionItem searchSuggestion;
         searchSuggestion.type = SuggestionType::Search;
         searchSuggestion.title = QString("搜索 \"%1\"").arg(input);
-        searchSuggestion.url = QString("https://www.bing.com/search?q=%1")
-            .arg(QString::fromUtf8(QUrl::toPercentEncoding(input)));
+        searchSuggestion.url = searchUrlFor(input);
         m_suggestions.append(searchSuggestion);
     }
 
@@ -202,6 +434,23 @@ void AddressBar::generateSuggestions(const QString &input)
         m_suggestions.append(urlSuggestion);
     }
 
+    // 添加历史记录建议：URL 前缀匹配（含书签）只查前缀树，立即显示
+    const QString query = input.trimmed();
+    if (m_navigationManager) {
+        const QList<SuggestionTrie::Match> prefixMatches = m_navigationManager->completeUrl(query, MAX_HISTORY_SUGGESTIONS);
+        for (const auto &match : std::as_const(prefixMatches)) {
+            SuggestionItem historySuggestion;
+            historySuggestion.type = SuggestionType::History;
+            historySuggestion.title = match.title;
+            historySuggestion.url = match.url;
+            m_suggestions.append(historySuggestion);
+        }
+    }
+
+    m_suggestions.append(remoteSuggestions);
+
+    // 新的输入：选中项清空，列表只更新变化的行
+    setSelectedSuggestion(-1);
     updateSuggestionsList();
 
     if (!m_suggestions.isEmpty()) {
@@ -211,17 +460,33 @@ void AddressBar::generateSuggestions(const QString &input)
     }
 }
 
-void AddressBar::updateSuggestionsList()
+void AddressBar::requestHistorySuggestions(const QString &input)
 {
-    m_suggestionsList->clear();
+    const QString query = input.trimmed();
+    if (!m_navigationManager || query.isEmpty()) {
+        return;
+    }
+
+    int historyCount = 0;
+    for (const auto &suggestion : std::as_const(m_suggestions)) {
+        if (suggestion.type == SuggestionType::History) {
+            ++historyCount;
+        }
+    }
 
-    int maxSuggestions = qMin(8, m_suggestions.size());
-    for (int i = 0; i < maxSuggestions; ++i) {
-        const auto &suggestion = m_suggestions[i];
-        QString displayText = QString("%1\n%2")
-            .arg(suggestion.title)
-            .arg(suggestion.url);
-        m_suggestionsList->addItem(displayText);
+    // 前缀匹配不足时在后台做子串匹配，结果到达后补充（见 onHistorySuggestionsReady）；
+    // 多取前缀匹配的数量，去重后仍能补满
+    if (historyCount < MAX_HISTORY_SUGGESTIONS) {
+        m_pendingGeneration = m_inputGeneration;
+        m_pendingRequestId = m_navigationManager->suggestHistoryAsync(query, MAX_HISTORY_SUGGESTIONS * 2);
+    }
+}
+
+void AddressBar::updateSuggestionsList()
+{
+    // 列表没有变化时视图不会重绘，这次按键不计入延迟，否则之后无关的重绘（悬停、滚动）会被记成它的样本
+    if (!m_suggestionsModel->setSuggestions(m_suggestions)) {
+        m_latencyPending = false;
     }
 }
 
@@ -229,73 +494,57 @@ void AddressBar::showSuggestions()
 {
     if (m_suggestions.isEmpty()) return;
 
-    m_suggestionsList->clear();
-    for (const auto &suggestion : m_suggestions) {
-        QString iconText;
-        QColor iconColor;
-
-        switch (suggestion.type) {
-        case SuggestionType::Search:
-            iconText = "🔍";
-            iconColor = QColor("#4285f4");
-            break;
-        case SuggestionType::Url:
-            iconText = "🌐";
-            iconColor = QColor("#34a853");
-            break;
-        case SuggestionType::History:
-            iconText = "🕐";
-            iconColor = QColor("#fbbc05");
-            break;
-        }
-
-        QString itemText = QString("%1 %2\n%3")
-            .arg(iconText)
-            .arg(suggestion.title)
-            .arg(suggestion.url);
-
-        QListWidgetItem *item = new QListWidgetItem(itemText);
-        m_suggestionsList->addItem(item);
-    }
-
-    m_suggestionsPanel->setGeometry(0, height(), width(), qMin(200, m_suggestionsList->sizeHintForRow(0) * m_suggestions.size() + 4));
+    m_suggestionsPanel->setGeometry(0, height(), width(), qMin(200, m_suggestionsList->sizeHintForRow(0) * int(m_suggestions.size()) + 4));
     m_suggestionsPanel->show();
     m_suggestionsPanel->raise();
     m_isShowingSuggestions = true;
-    m_selectedSuggestionIndex = -1;
 }
 
 void AddressBar::hideSuggestions()
 {
+    cancelPendingSuggestions();
+    m_remoteSuggestionsTimer->stop();
+    m_remoteSuggestions->cancel();
     m_suggestionsPanel->hide();
     m_isShowingSuggestions = false;
-    m_selectedSuggestionIndex = -1;
+    setSelectedSuggestion(-1);
+}
+
+void AddressBar::setSelectedSuggestion(int row)
+{
+    m_selectedSuggestionIndex = row;
+    if (row < 0) {
+        m_suggestionsList->clearSelection();
+        m_suggestionsList->setCurrentIndex(QModelIndex());
+    } else {
+        m_suggestionsList->setCurrentIndex(m_suggestionsModel->index(row));
+    }
 }
 
 void AddressBar::selectNextSuggestion()
 {
     if (m_suggestions.isEmpty()) return;
 
-    m_selectedSuggestionIndex++;
-    if (m_selectedSuggestionIndex >= m_suggestionsList->count()) {
-        m_selectedSuggestionIndex = 0;
+    int row = m_selectedSuggestionIndex + 1;
+    if (row >= m_suggestions.size()) {
+        row = 0;
     }
 
-    m_suggestionsList->setCurrentRow(m_selectedSuggestionIndex);
-    m_addressTextBox->setText(m_suggestions[m_selectedSuggestionIndex].url);
+    setSelectedSuggestion(row);
+    m_addressTextBox->setText(m_suggestions[row].url);
 }
 
 void AddressBar::selectPreviousSuggestion()
 {
     if (m_suggestions.isEmpty()) return;
 
-    m_selectedSuggestionIndex--;
-    if (m_selectedSuggestionIndex < 0) {
-        m_selectedSuggestionIndex = m_suggestionsList->count() - 1;
+    int row = m_selectedSuggestionIndex - 1;
+    if (row < 0) {
+        row = int(m_suggestions.size()) - 1;
     }
 
-    m_suggestionsList->setCurrentRow(m_selectedSuggestionIndex);
-    m_addressTextBox->setText(m_suggestions[m_selectedSuggestionIndex].url);
+    setSelectedSuggestion(row);
+    m_addressTextBox->setText(m_suggestions[row].url);
 }
 
 void AddressBar::navigate()
@@ -322,10 +571,8 @@ void AddressBar::navigateTo(const QString &url)
         emit navigateRequested(url);
     } else {
         // 否则进行搜索
-        QString searchUrl = QString("https://www.bing.com/search?q=%1")
-            .arg(QString::fromUtf8(QUrl::toPercentEncoding(url)));
         emit searchRequested(url);
-        emit navigateRequested(searchUrl);
+        emit navigateRequested(searchUrlFor(url));
     }
     hideSuggestions();
 }
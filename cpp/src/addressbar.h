@@ -5,25 +5,18 @@
 #include <QWidget>
 #include <QLineEdit>
 #include <QPushButton>
-#include <QListWidget>
+#include <QListView>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QNetworkAccessManager>
+#include "latencyhistogram.h"
+#include "suggestionlistmodel.h"
+#include "remotesuggestionprovider.h"
+#include "models/historyitem.h"
 
 namespace WinBrowserQt {
 
-enum class SuggestionType {
-    Search,
-    Url,
-    History
-};
-
-class SuggestionItem
-{
-public:
-    QString title;
-    QString url;
-    SuggestionType type;
-};
+class NavigationManager;
 
 class AddressBar : public QWidget
 {
@@ -32,11 +25,20 @@ class AddressBar : public QWidget
 public:
     explicit AddressBar(QWidget *parent = nullptr);
 
+    // 提供历史记录和书签建议（前缀匹配在前，其余子串匹配在后，均按 frecency 排序）和内联补全
+    void setNavigationManager(NavigationManager *navigationManager);
+    // 远程搜索建议的端点，见 RemoteSuggestionProvider；为空时关闭
+    void setRemoteSuggestionEndpoint(const QString &urlTemplate);
+
     void setUrl(const QString &url);
     QString getUrl() const;
     void focusAddressBox();
     void clear();
 
+    // 按键到建议列表绘制的延迟（微秒）；按键后列表内容没有变化（不会重绘）时不计入
+    const LatencyHistogram &inputLatency() const { return m_inputLatency; }
+    void logLatencyStats() const;
+
 signals:
     void navigateRequested(const QString &url);
     void searchRequested(const QString &searchTerm);
@@ -46,16 +48,30 @@ protected:
     void resizeEvent(QResizeEvent *event) override;
 
 private slots:
-    void onTextChanged(const QString &text);
+    void onTextEdited(const QString &text);
     void onGoButtonClicked();
-    void onSuggestionSelected();
+    void onSuggestionSelected(const QModelIndex &index);
     void onSuggestionsTimerTimeout();
+    void onHistorySuggestionsReady(quint64 requestId, const QString &query, const QList<HistoryItem> &results);
+    void onRemoteSuggestionsTimerTimeout();
+    void onRemoteSuggestionsReady(const QString &query, const QStringList &suggestions, bool provisional);
 
 private:
     void initializeUI();
     void setupEventHandlers();
+    // 本地的快速来源（搜索、URL、前缀树），每次按键立即执行
     void generateSuggestions(const QString &input);
+    // 开销较大的来源（后台子串搜索），按输入节奏防抖后执行
+    void requestHistorySuggestions(const QString &input);
+    void setRemoteSuggestions(const QStringList &suggestions);
+    void recordKeystroke();
+    int debounceInterval(double factor, int minMs, int maxMs) const;
+    static QString searchUrlFor(const QString &term);
+    void applyInlineCompletion(const QString &typed);
+    void cancelPendingSuggestions();
+    // 把 m_suggestions 交给模型，模型只通知变化的行
     void updateSuggestionsList();
+    void setSelectedSuggestion(int row);
     void showSuggestions();
     void hideSuggestions();
     void selectNextSuggestion();
@@ -70,14 +86,46 @@ private:
 
     QLineEdit *m_addressTextBox;
     QPushButton *m_goButton;
-    QListWidget *m_suggestionsList;
+    QListView *m_suggestionsList;
+    SuggestionListModel *m_suggestionsModel;
     QWidget *m_suggestionsPanel;
     QTimer *m_suggestionsTimer;
     QNetworkAccessManager *m_networkManager;
+    RemoteSuggestionProvider *m_remoteSuggestions;
+    QTimer *m_remoteSuggestionsTimer;
+    NavigationManager *m_navigationManager;
 
     QList<SuggestionItem> m_suggestions;
+    QString m_typedText;        // 用户输入的部分，不含内联补全
+
+    // 每次按键递增；后台搜索的结果只有在发出请求后没有新的按键时才显示
+    quint64 m_inputGeneration;
+    quint64 m_pendingRequestId;         // 0 表示没有进行中的请求
+    quint64 m_pendingGeneration;
+
+    // 输入节奏：相邻按键间隔的指数滑动平均，停顿不计入
+    QElapsedTimer m_inputClock;
+    qint64 m_lastKeystrokeMs;
+    double m_typingIntervalMs;
+    // 按键到绘制：按键时开始计时，建议列表下一次绘制时记录
+    QElapsedTimer m_latencyClock;
+    bool m_latencyPending;
+    LatencyHistogram m_inputLatency;
     int m_selectedSuggestionIndex;
     bool m_isShowingSuggestions;
+
+    static const int MAX_HISTORY_SUGGESTIONS = 5;
+    static const int MAX_REMOTE_SUGGESTIONS = 4;
+    // 防抖时间为平均按键间隔的 DEBOUNCE_FACTOR 倍，限制在 [MIN, MAX] 内
+    static const int MIN_DEBOUNCE_MS = 30;
+    static const int MAX_DEBOUNCE_MS = 300;
+    static constexpr double DEBOUNCE_FACTOR = 1.5;
+    // 远程建议的往返开销更大，等待更长的停顿
+    static const int MIN_REMOTE_DEBOUNCE_MS = 100;
+    static const int MAX_REMOTE_DEBOUNCE_MS = 500;
+    static constexpr double REMOTE_DEBOUNCE_FACTOR = 2.5;
+    // 超过这个间隔视为停顿，不计入输入节奏
+    static const int TYPING_PAUSE_MS = 1000;
 };
 
 } // namespace WinBrowserQt
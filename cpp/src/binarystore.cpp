@@ -0,0 +1,418 @@
+#include "binarystore.h"
+#include <QHash>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+namespace WinBrowserQt {
+
+namespace {
+
+const char HISTORY_MAGIC[4] = { 'W', 'B', 'H', 'S' };
+const char BOOKMARK_MAGIC[4] = { 'W', 'B', 'B', 'M' };
+const char FOLDER_MAGIC[4] = { 'W', 'B', 'F', 'D' };
+
+const qsizetype HEADER_SIZE = 32;
+const quint32 HISTORY_RECORD_SIZE = 40;
+const quint32 BOOKMARK_RECORD_SIZE = 48;
+// 加入 parentId 之前的书签记录长度
+const quint32 BOOKMARK_MIN_RECORD_SIZE = 40;
+const quint32 FOLDER_RECORD_SIZE = 32;
+
+// 无效时间使用的哨兵值
+const qint64 INVALID_TIME = std::numeric_limits<qint64>::min();
+
+qint64 toEpochMSecs(const QDateTime &dateTime)
+{
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : INVALID_TIME;
+}
+
+QDateTime fromEpochMSecs(qint64 msecs)
+{
+    return msecs == INVALID_TIME ? QDateTime() : QDateTime::fromMSecsSinceEpoch(msecs);
+}
+
+// 构建去重后的字符串表，重复出现的 URL、标题、文件夹只存一份
+class StringTableBuilder
+{
+public:
+    void writeRef(uchar *field, const QString &value)
+    {
+        quint32 offset = 0;
+        auto it = m_offsets.constFind(value);
+        if (it != m_offsets.constEnd()) {
+            offset = it.value();
+        } else {
+            offset = quint32(m_data.size() / 2);
+            m_offsets.insert(value, offset);
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+            for (QChar ch : value) {
+                const quint16 unit = qToLittleEndian<quint16>(quint16(ch.unicode()));
+                m_data.append(reinterpret_cast<const char *>(&unit), 2);
+            }
+#else
+            m_data.append(reinterpret_cast<const char *>(value.utf16()), value.size() * 2);
+#endif
+        }
+        qToLittleEndian<quint32>(offset, field);
+        qToLittleEndian<quint32>(quint32(value.size()), field + 4);
+    }
+
+    const QByteArray &data() const { return m_data; }
+
+private:
+    QHash<QString, quint32> m_offsets;
+    QByteArray m_data;
+};
+
+QByteArray buildRecordFile(const char *magic, quint32 recordCount, quint32 recordSize,
+                           const QByteArray &records, const QByteArray &strings)
+{
+    QByteArray data(HEADER_SIZE, '\0');
+    uchar *h = reinterpret_cast<uchar *>(data.data());
+    std::memcpy(h, magic, 4);
+    qToLittleEndian<quint32>(BinaryStore::FORMAT_VERSION, h + 4);
+    qToLittleEndian<quint32>(recordCount, h + 8);
+    qToLittleEndian<quint32>(recordSize, h + 12);
+    qToLittleEndian<quint64>(quint64(HEADER_SIZE + records.size()), h + 16);
+    qToLittleEndian<quint64>(quint64(strings.size()), h + 24);
+
+    data.reserve(HEADER_SIZE + records.size() + strings.size());
+    data.append(records);
+    data.append(strings);
+    return data;
+}
+
+template <typename Container>
+QByteArray serializeHistoryRecords(const Container &history)
+{
+    QByteArray records(qsizetype(history.size()) * HISTORY_RECORD_SIZE, '\0');
+    StringTableBuilder strings;
+
+    uchar *out = reinterpret_cast<uchar *>(records.data());
+    for (const auto &item : history) {
+        strings.writeRef(out, item.id());
+        strings.writeRef(out + 8, item.url());
+        strings.writeRef(out + 16, item.title());
+        qToLittleEndian<qint64>(toEpochMSecs(item.timestamp()), out + 24);
+        qToLittleEndian<qint32>(item.visitCount(), out + 32);
+        out += HISTORY_RECORD_SIZE;
+    }
+
+    return buildRecordFile(HISTORY_MAGIC, quint32(history.size()),
+                           HISTORY_RECORD_SIZE, records, strings.data());
+}
+
+template <typename Container>
+QByteArray serializeBookmarkRecords(const Container &bookmarks)
+{
+    QByteArray records(qsizetype(bookmarks.size()) * BOOKMARK_RECORD_SIZE, '\0');
+    StringTableBuilder strings;
+
+    uchar *out = reinterpret_cast<uchar *>(records.data());
+    for (const auto &bookmark : bookmarks) {
+        strings.writeRef(out, bookmark.id());
+        strings.writeRef(out + 8, bookmark.title());
+        strings.writeRef(out + 16, bookmark.url());
+        strings.writeRef(out + 24, bookmark.folder());
+        qToLittleEndian<qint64>(toEpochMSecs(bookmark.dateAdded()), out + 32);
+        strings.writeRef(out + 40, bookmark.parentId());
+        out += BOOKMARK_RECORD_SIZE;
+    }
+
+    return buildRecordFile(BOOKMARK_MAGIC, quint32(bookmarks.size()),
+                           BOOKMARK_RECORD_SIZE, records, strings.data());
+}
+
+QByteArray serializeFolderRecords(const QList<BookmarkFolder> &folders)
+{
+    QByteArray records(qsizetype(folders.size()) * FOLDER_RECORD_SIZE, '\0');
+    StringTableBuilder strings;
+
+    uchar *out = reinterpret_cast<uchar *>(records.data());
+    for (const auto &folder : folders) {
+        strings.writeRef(out, folder.id());
+        strings.writeRef(out + 8, folder.title());
+        strings.writeRef(out + 16, folder.parentId());
+        qToLittleEndian<qint64>(toEpochMSecs(folder.dateAdded()), out + 24);
+        out += FOLDER_RECORD_SIZE;
+    }
+
+    return buildRecordFile(FOLDER_MAGIC, quint32(folders.size()),
+                           FOLDER_RECORD_SIZE, records, strings.data());
+}
+
+} // namespace
+
+MappedRecordFile::~MappedRecordFile()
+{
+    close();
+}
+
+bool MappedRecordFile::open(const QString &path, const char *magic, quint32 recordSize)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.exists() || !m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 fileSize = m_file.size();
+    if (fileSize < HEADER_SIZE) {
+        qWarning() << "二进制存储文件过短:" << path;
+        m_file.close();
+        return false;
+    }
+
+    m_mapped = m_file.map(0, fileSize);
+    if (!m_mapped) {
+        qWarning() << "映射二进制存储文件失败:" << path << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    if (!attach(m_mapped, fileSize, magic, recordSize)) {
+        qWarning() << "二进制存储文件格式或版本不匹配:" << path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedRecordFile::openData(const QByteArray &data, const char *magic, quint32 recordSize)
+{
+    close();
+
+    // QByteArray 是隐式共享的，持有一份引用即可保证数据在访问期间有效
+    m_buffer = data;
+    if (m_buffer.size() < HEADER_SIZE
+        || !attach(reinterpret_cast<const uchar *>(m_buffer.constData()), m_buffer.size(), magic, recordSize)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedRecordFile::attach(const uchar *data, qint64 size, const char *magic, quint32 recordSize)
+{
+    m_data = data;
+
+    const quint32 version = qFromLittleEndian<quint32>(m_data + 4);
+    const quint32 count = qFromLittleEndian<quint32>(m_data + 8);
+    const quint32 storedRecordSize = qFromLittleEndian<quint32>(m_data + 12);
+    const quint64 stringOffset = qFromLittleEndian<quint64>(m_data + 16);
+    const quint64 stringSize = qFromLittleEndian<quint64>(m_data + 24);
+
+    const bool valid = std::memcmp(m_data, magic, 4) == 0
+        && version == BinaryStore::FORMAT_VERSION
+        && storedRecordSize >= recordSize
+        && count <= quint32(std::numeric_limits<int>::max())
+        && quint64(HEADER_SIZE) + quint64(count) * storedRecordSize <= stringOffset
+        && stringOffset + stringSize <= quint64(size)
+        && stringSize % 2 == 0
+        && stringOffset % 2 == 0;
+
+    if (!valid) {
+        return false;
+    }
+
+    m_records = m_data + HEADER_SIZE;
+    m_stringCount = quint32(stringSize / 2);
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    // 字符串表一次性转换为本机字节序，之后的字段访问与小端平台一样不再复制
+    m_nativeStrings.resize(qsizetype(stringSize));
+    qFromLittleEndian<quint16>(m_data + stringOffset, qsizetype(m_stringCount), m_nativeStrings.data());
+    m_strings = reinterpret_cast<const char16_t *>(m_nativeStrings.constData());
+#else
+    m_strings = reinterpret_cast<const char16_t *>(m_data + stringOffset);
+#endif
+    m_recordSize = storedRecordSize;
+    m_recordCount = int(count);
+    return true;
+}
+
+void MappedRecordFile::close()
+{
+    if (m_mapped) {
+        m_file.unmap(m_mapped);
+        m_mapped = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_buffer.clear();
+    m_nativeStrings.clear();
+    m_data = nullptr;
+    m_records = nullptr;
+    m_strings = nullptr;
+    m_stringCount = 0;
+    m_recordCount = 0;
+}
+
+QString MappedRecordFile::stringAt(const uchar *field) const
+{
+    return stringViewAt(field).toString();
+}
+
+QStringView MappedRecordFile::stringViewAt(const uchar *field) const
+{
+    const quint32 offset = qFromLittleEndian<quint32>(field);
+    const quint32 length = qFromLittleEndian<quint32>(field + 4);
+    if (quint64(offset) + length > m_stringCount) {
+        return QStringView();
+    }
+    return QStringView(m_strings + offset, qsizetype(length));
+}
+
+qint64 MappedRecordFile::int64At(const uchar *field)
+{
+    return qFromLittleEndian<qint64>(field);
+}
+
+qint32 MappedRecordFile::int32At(const uchar *field)
+{
+    return qFromLittleEndian<qint32>(field);
+}
+
+// 历史记录：id(8) url(8) title(8) timestamp(8) visitCount(4) 保留(4)
+bool MappedHistoryFile::open(const QString &path)
+{
+    return MappedRecordFile::open(path, HISTORY_MAGIC, HISTORY_RECORD_SIZE);
+}
+
+bool MappedHistoryFile::openData(const QByteArray &data)
+{
+    return MappedRecordFile::openData(data, HISTORY_MAGIC, HISTORY_RECORD_SIZE);
+}
+
+QString MappedHistoryFile::id(int index) const { return stringAt(record(index)); }
+QString MappedHistoryFile::url(int index) const { return stringAt(record(index) + 8); }
+QString MappedHistoryFile::title(int index) const { return stringAt(record(index) + 16); }
+QDateTime MappedHistoryFile::timestamp(int index) const { return fromEpochMSecs(int64At(record(index) + 24)); }
+int MappedHistoryFile::visitCount(int index) const { return int32At(record(index) + 32); }
+
+QStringView MappedHistoryFile::idView(int index) const { return stringViewAt(record(index)); }
+QStringView MappedHistoryFile::urlView(int index) const { return stringViewAt(record(index) + 8); }
+QStringView MappedHistoryFile::titleView(int index) const { return stringViewAt(record(index) + 16); }
+qint64 MappedHistoryFile::timestampMSecs(int index) const { return int64At(record(index) + 24); }
+
+HistoryItem MappedHistoryFile::itemAt(int index) const
+{
+    HistoryItem item;
+    item.setId(id(index));
+    item.setUrl(url(index));
+    item.setTitle(title(index));
+    item.setTimestamp(timestamp(index));
+    item.setVisitCount(visitCount(index));
+    return item;
+}
+
+QList<HistoryItem> MappedHistoryFile::items() const
+{
+    QList<HistoryItem> history;
+    history.reserve(count());
+    for (int i = 0; i < count(); ++i) {
+        history.append(itemAt(i));
+    }
+    return history;
+}
+
+// 书签：id(8) title(8) url(8) folder(8) dateAdded(8) parentId(8)
+// 旧文件没有 parentId，读取时为空，由文件夹树按 folder 名称迁移
+bool MappedBookmarkFile::open(const QString &path)
+{
+    return MappedRecordFile::open(path, BOOKMARK_MAGIC, BOOKMARK_MIN_RECORD_SIZE);
+}
+
+QString MappedBookmarkFile::id(int index) const { return stringAt(record(index)); }
+QString MappedBookmarkFile::title(int index) const { return stringAt(record(index) + 8); }
+QString MappedBookmarkFile::url(int index) const { return stringAt(record(index) + 16); }
+QString MappedBookmarkFile::folder(int index) const { return stringAt(record(index) + 24); }
+QDateTime MappedBookmarkFile::dateAdded(int index) const { return fromEpochMSecs(int64At(record(index) + 32)); }
+
+QString MappedBookmarkFile::parentId(int index) const
+{
+    return recordSize() >= BOOKMARK_RECORD_SIZE ? stringAt(record(index) + 40) : QString();
+}
+
+Bookmark MappedBookmarkFile::itemAt(int index) const
+{
+    Bookmark bookmark;
+    bookmark.setId(id(index));
+    bookmark.setTitle(title(index));
+    bookmark.setUrl(url(index));
+    bookmark.setFolder(folder(index));
+    bookmark.setDateAdded(dateAdded(index));
+    bookmark.setParentId(parentId(index));
+    return bookmark;
+}
+
+QList<Bookmark> MappedBookmarkFile::items() const
+{
+    QList<Bookmark> bookmarks;
+    bookmarks.reserve(count());
+    for (int i = 0; i < count(); ++i) {
+        bookmarks.append(itemAt(i));
+    }
+    return bookmarks;
+}
+
+// 书签文件夹：id(8) title(8) parentId(8) dateAdded(8)
+bool MappedBookmarkFolderFile::open(const QString &path)
+{
+    return MappedRecordFile::open(path, FOLDER_MAGIC, FOLDER_RECORD_SIZE);
+}
+
+QString MappedBookmarkFolderFile::id(int index) const { return stringAt(record(index)); }
+QString MappedBookmarkFolderFile::title(int index) const { return stringAt(record(index) + 8); }
+QString MappedBookmarkFolderFile::parentId(int index) const { return stringAt(record(index) + 16); }
+QDateTime MappedBookmarkFolderFile::dateAdded(int index) const { return fromEpochMSecs(int64At(record(index) + 24)); }
+
+BookmarkFolder MappedBookmarkFolderFile::itemAt(int index) const
+{
+    BookmarkFolder folder;
+    folder.setId(id(index));
+    folder.setTitle(title(index));
+    folder.setParentId(parentId(index));
+    folder.setDateAdded(dateAdded(index));
+    return folder;
+}
+
+QList<BookmarkFolder> MappedBookmarkFolderFile::items() const
+{
+    QList<BookmarkFolder> folders;
+    folders.reserve(count());
+    for (int i = 0; i < count(); ++i) {
+        folders.append(itemAt(i));
+    }
+    return folders;
+}
+
+QByteArray BinaryStore::serializeHistory(const QList<HistoryItem> &history)
+{
+    return serializeHistoryRecords(history);
+}
+
+QByteArray BinaryStore::serializeHistory(const PersistentList<HistoryItem>::Snapshot &history)
+{
+    return serializeHistoryRecords(history);
+}
+
+QByteArray BinaryStore::serializeBookmarks(const QList<Bookmark> &bookmarks)
+{
+    return serializeBookmarkRecords(bookmarks);
+}
+
+QByteArray BinaryStore::serializeBookmarks(const PersistentList<Bookmark>::Snapshot &bookmarks)
+{
+    return serializeBookmarkRecords(bookmarks);
+}
+
+QByteArray BinaryStore::serializeBookmarkFolders(const QList<BookmarkFolder> &folders)
+{
+    return serializeFolderRecords(folders);
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,129 @@
+#ifndef BINARYSTORE_H
+#define BINARYSTORE_H
+
+#include <QString>
+#include <QStringView>
+#include <QList>
+#include <QFile>
+#include "models/bookmark.h"
+#include "models/bookmarkfolder.h"
+#include "models/historyitem.h"
+#include "models/persistentlist.h"
+
+namespace WinBrowserQt {
+
+// 二进制存储格式（小端）：
+//   文件头   magic[4] | version u32 | recordCount u32 | recordSize u32 | stringTableOffset u64 | stringTableSize u64
+//   记录区   recordCount 条定长记录，字符串字段以 (offset u32, length u32) 引用字符串表；
+//            新版本只在记录末尾追加字段，读取时接受不小于最小长度的记录
+//   字符串表 去重后的 UTF-16 字符数据
+// 读取时通过 QFile::map 映射整个文件，字段在访问时才解码：按下标访问单个字段，
+// *View 访问函数直接指向映射中的字符串表，不分配内存，只在文件打开期间有效；
+// 也可以直接读取内存中的数据（例如解压后的归档段）
+class MappedRecordFile
+{
+public:
+    MappedRecordFile() = default;
+    ~MappedRecordFile();
+
+    MappedRecordFile(const MappedRecordFile &) = delete;
+    MappedRecordFile &operator=(const MappedRecordFile &) = delete;
+
+    bool open(const QString &path, const char *magic, quint32 recordSize);
+    bool openData(const QByteArray &data, const char *magic, quint32 recordSize);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    int count() const { return m_recordCount; }
+    quint32 recordSize() const { return m_recordSize; }
+
+protected:
+    const uchar *record(int index) const { return m_records + qsizetype(index) * m_recordSize; }
+    QString stringAt(const uchar *field) const;
+    QStringView stringViewAt(const uchar *field) const;
+    static qint64 int64At(const uchar *field);
+    static qint32 int32At(const uchar *field);
+
+private:
+    bool attach(const uchar *data, qint64 size, const char *magic, quint32 recordSize);
+
+    QFile m_file;
+    QByteArray m_buffer;
+    QByteArray m_nativeStrings;     // 大端平台上转换为本机字节序的字符串表
+    uchar *m_mapped = nullptr;
+    const uchar *m_data = nullptr;
+    const uchar *m_records = nullptr;
+    const char16_t *m_strings = nullptr;
+    quint32 m_stringCount = 0;
+    quint32 m_recordSize = 0;
+    int m_recordCount = 0;
+};
+
+class MappedHistoryFile : public MappedRecordFile
+{
+public:
+    bool open(const QString &path);
+    bool openData(const QByteArray &data);
+
+    QString id(int index) const;
+    QString url(int index) const;
+    QString title(int index) const;
+    QDateTime timestamp(int index) const;
+    int visitCount(int index) const;
+
+    QStringView idView(int index) const;
+    QStringView urlView(int index) const;
+    QStringView titleView(int index) const;
+    // 无效时间为 qint64 的最小值
+    qint64 timestampMSecs(int index) const;
+
+    HistoryItem itemAt(int index) const;
+    // 解码全部记录，只用于需要完整列表的场合（加载到内存中的历史记录、导出）
+    QList<HistoryItem> items() const;
+};
+
+class MappedBookmarkFile : public MappedRecordFile
+{
+public:
+    bool open(const QString &path);
+
+    QString id(int index) const;
+    QString title(int index) const;
+    QString url(int index) const;
+    QString folder(int index) const;
+    QDateTime dateAdded(int index) const;
+    QString parentId(int index) const;
+
+    Bookmark itemAt(int index) const;
+    QList<Bookmark> items() const;
+};
+
+class MappedBookmarkFolderFile : public MappedRecordFile
+{
+public:
+    bool open(const QString &path);
+
+    QString id(int index) const;
+    QString title(int index) const;
+    QString parentId(int index) const;
+    QDateTime dateAdded(int index) const;
+
+    BookmarkFolder itemAt(int index) const;
+    QList<BookmarkFolder> items() const;
+};
+
+class BinaryStore
+{
+public:
+    static const quint32 FORMAT_VERSION = 1;
+
+    static QByteArray serializeHistory(const QList<HistoryItem> &history);
+    static QByteArray serializeHistory(const PersistentList<HistoryItem>::Snapshot &history);
+    static QByteArray serializeBookmarks(const QList<Bookmark> &bookmarks);
+    static QByteArray serializeBookmarks(const PersistentList<Bookmark>::Snapshot &bookmarks);
+    static QByteArray serializeBookmarkFolders(const QList<BookmarkFolder> &folders);
+};
+
+} // namespace WinBrowserQt
+
+#endif // BINARYSTORE_H
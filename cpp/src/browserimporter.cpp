@@ -0,0 +1,894 @@
+#include "browserimporter.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QStringDecoder>
+#include <QStringList>
+#include <QHash>
+#include <QUuid>
+#include <QDebug>
+#ifdef WINBROWSER_HAS_SQLITE
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#endif
+
+namespace WinBrowserQt {
+
+namespace {
+
+// Chrome 的时间是 1601-01-01 起的微秒数
+const qint64 CHROME_EPOCH_OFFSET_MS = 11644473600000LL;
+// 单个标题最多保留的字符数，防止损坏的文件让缓冲区无限增长
+const int MAX_TEXT_LENGTH = 4096;
+// 单个标签最多保留的字符数：超出的部分（例如很长的 ICON="data:..." 属性或没有 '>' 的损坏标签）丢弃，
+// HREF、ADD_DATE 等需要的属性都在标签开头
+const int MAX_TAG_LENGTH = 16 * 1024;
+
+QString newId()
+{
+    return QUuid::createUuid().toString();
+}
+
+QDateTime fromUnixSeconds(const QString &value)
+{
+    bool ok = false;
+    const qint64 seconds = value.toLongLong(&ok);
+    return ok && seconds > 0 ? QDateTime::fromSecsSinceEpoch(seconds) : QDateTime();
+}
+
+QDateTime fromChromeTime(const QString &value)
+{
+    bool ok = false;
+    const qint64 micros = value.toLongLong(&ok);
+    return ok && micros > 0 ? QDateTime::fromMSecsSinceEpoch(micros / 1000 - CHROME_EPOCH_OFFSET_MS) : QDateTime();
+}
+
+// Firefox 的时间是 Unix 纪元起的微秒数
+QDateTime fromFirefoxTime(qint64 micros)
+{
+    return micros > 0 ? QDateTime::fromMSecsSinceEpoch(micros / 1000) : QDateTime();
+}
+
+// 书签 HTML 中只会出现少量实体
+QString decodeEntities(QStringView text)
+{
+    if (!text.contains('&')) {
+        return text.toString();
+    }
+
+    QString result;
+    result.reserve(text.size());
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const qsizetype end = text[i] == '&' ? text.indexOf(';', i) : -1;
+        if (end < 0 || end - i > 10) {
+            result.append(text[i]);
+            continue;
+        }
+
+        const QStringView entity = text.mid(i + 1, end - i - 1);
+        if (entity == u"amp") {
+            result.append('&');
+        } else if (entity == u"lt") {
+            result.append('<');
+        } else if (entity == u"gt") {
+            result.append('>');
+        } else if (entity == u"quot") {
+            result.append('"');
+        } else if (entity == u"apos") {
+            result.append('\'');
+        } else if (entity.startsWith('#')) {
+            bool ok = false;
+            const uint code = entity.startsWith(u"#x", Qt::CaseInsensitive)
+                ? entity.mid(2).toUInt(&ok, 16) : entity.mid(1).toUInt(&ok, 10);
+            if (!ok) {
+                result.append(text.mid(i, end - i + 1));
+            } else {
+                const char32_t codePoint = code;
+                result.append(QString::fromUcs4(&codePoint, 1));
+            }
+        } else {
+            result.append(text.mid(i, end - i + 1));
+        }
+        i = end;
+    }
+    return result;
+}
+
+// 从 `A HREF="..." ADD_DATE="..."` 形式的标签内容中取出属性值
+QString tagAttribute(QStringView tag, QStringView name)
+{
+    const qsizetype n = tag.size();
+    qsizetype i = 0;
+    while (i < n && !tag[i].isSpace()) {
+        ++i;
+    }
+
+    while (i < n) {
+        while (i < n && tag[i].isSpace()) {
+            ++i;
+        }
+        const qsizetype nameStart = i;
+        while (i < n && !tag[i].isSpace() && tag[i] != '=') {
+            ++i;
+        }
+        const QStringView attribute = tag.mid(nameStart, i - nameStart);
+        while (i < n && tag[i].isSpace()) {
+            ++i;
+        }
+
+        QStringView value;
+        if (i < n && tag[i] == '=') {
+            ++i;
+            while (i < n && tag[i].isSpace()) {
+                ++i;
+            }
+            if (i < n && (tag[i] == '"' || tag[i] == '\'')) {
+                const QChar quote = tag[i++];
+                const qsizetype valueStart = i;
+                while (i < n && tag[i] != quote) {
+                    ++i;
+                }
+                value = tag.mid(valueStart, i - valueStart);
+                ++i;
+            } else {
+                const qsizetype valueStart = i;
+                while (i < n && !tag[i].isSpace()) {
+                    ++i;
+                }
+                value = tag.mid(valueStart, i - valueStart);
+            }
+        } else if (attribute.isEmpty()) {
+            ++i;
+        }
+
+        if (attribute.compare(name, Qt::CaseInsensitive) == 0) {
+            return decodeEntities(value);
+        }
+    }
+    return QString();
+}
+
+// 增量 JSON 词法分析器：按块从设备读取，只保留当前块和正在读取的字符串
+// 不校验逗号和冒号的位置，足以读取格式正确的 Chrome 书签文件
+class JsonStreamReader
+{
+public:
+    enum Token {
+        Invalid,
+        EndOfData,
+        ObjectStart,
+        ObjectEnd,
+        ArrayStart,
+        ArrayEnd,
+        Key,
+        String,
+        Number,
+        Literal
+    };
+
+    JsonStreamReader(QIODevice *device, int chunkSize)
+        : m_device(device)
+        , m_chunkSize(chunkSize)
+        , m_pos(0)
+    {
+    }
+
+    Token next()
+    {
+        while (true) {
+            const int c = getChar();
+            switch (c) {
+            case -1:
+                return EndOfData;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+            case ',':
+            case ':':
+                continue;
+            case '{':
+                return ObjectStart;
+            case '}':
+                return ObjectEnd;
+            case '[':
+                return ArrayStart;
+            case ']':
+                return ArrayEnd;
+            case '"':
+                if (!readString()) {
+                    return Invalid;
+                }
+                // 后面紧跟冒号的字符串是对象的键
+                while (true) {
+                    const int p = peekChar();
+                    if (p == ' ' || p == '\t' || p == '\n' || p == '\r') {
+                        getChar();
+                        continue;
+                    }
+                    if (p == ':') {
+                        getChar();
+                        return Key;
+                    }
+                    return String;
+                }
+            default:
+                if (c == '-' || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')) {
+                    QByteArray scalar(1, char(c));
+                    for (int p = peekChar(); p == '-' || p == '+' || p == '.' || (p >= '0' && p <= '9')
+                         || (p >= 'a' && p <= 'z') || (p >= 'A' && p <= 'Z'); p = peekChar()) {
+                        scalar.append(char(getChar()));
+                    }
+                    m_text = QString::fromLatin1(scalar);
+                    return (c >= 'a' && c <= 'z') ? Literal : Number;
+                }
+                return Invalid;
+            }
+        }
+    }
+
+    // Key、String、Number、Literal 的内容
+    QString text() const { return m_text; }
+    qint64 position() const { return m_device->pos() - (m_buffer.size() - m_pos); }
+
+private:
+    int peekChar()
+    {
+        if (m_pos >= m_buffer.size() && !refill()) {
+            return -1;
+        }
+        return uchar(m_buffer[m_pos]);
+    }
+
+    int getChar()
+    {
+        if (m_pos >= m_buffer.size() && !refill()) {
+            return -1;
+        }
+        return uchar(m_buffer[m_pos++]);
+    }
+
+    bool refill()
+    {
+        m_buffer = m_device->read(m_chunkSize);
+        m_pos = 0;
+        return !m_buffer.isEmpty();
+    }
+
+    static int hexValue(int c)
+    {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    bool readString()
+    {
+        // 未转义的部分按 UTF-8 字节累积，遇到转义时再解码
+        m_text.clear();
+        QByteArray raw;
+        while (true) {
+            const int c = getChar();
+            if (c < 0) {
+                return false;
+            }
+            if (c == '"') {
+                break;
+            }
+            if (c != '\\') {
+                raw.append(char(c));
+                continue;
+            }
+
+            const int e = getChar();
+            char plain = 0;
+            switch (e) {
+            case '"': plain = '"'; break;
+            case '\\': plain = '\\'; break;
+            case '/': plain = '/'; break;
+            case 'b': plain = '\b'; break;
+            case 'f': plain = '\f'; break;
+            case 'n': plain = '\n'; break;
+            case 'r': plain = '\r'; break;
+            case 't': plain = '\t'; break;
+            case 'u': {
+                int code = 0;
+                for (int k = 0; k < 4; ++k) {
+                    const int digit = hexValue(getChar());
+                    if (digit < 0) {
+                        return false;
+                    }
+                    code = code * 16 + digit;
+                }
+                // 代理对的两半分别追加，合起来就是正确的 UTF-16
+                m_text += QString::fromUtf8(raw);
+                raw.clear();
+                m_text.append(QChar(char16_t(code)));
+                continue;
+            }
+            default:
+                return false;
+            }
+            raw.append(plain);
+        }
+        m_text += QString::fromUtf8(raw);
+        return true;
+    }
+
+    QIODevice *m_device;
+    int m_chunkSize;
+    QByteArray m_buffer;
+    qsizetype m_pos;
+    QString m_text;
+};
+
+} // namespace
+
+BrowserImporter::BrowserImporter(const QString &path, Format format, QObject *parent)
+    : QThread(parent)
+    , m_path(path)
+    , m_format(format)
+    , m_cancelled(0)
+    , m_credits(MAX_PENDING_BATCHES)
+    , m_lastPermille(-1)
+{
+}
+
+BrowserImporter::~BrowserImporter()
+{
+    cancel();
+    wait();
+}
+
+BrowserImporter::Format BrowserImporter::detectFormat(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return Format::Unknown;
+    }
+
+    const QByteArray head = file.read(4096);
+    if (head.startsWith(QByteArrayLiteral("SQLite format 3"))) {
+        return Format::FirefoxPlaces;
+    }
+
+    const QByteArray trimmed = head.trimmed();
+    if (trimmed.startsWith('{') && head.contains("\"roots\"")) {
+        return Format::ChromeJson;
+    }
+    const QByteArray upper = head.toUpper();
+    if (upper.contains("NETSCAPE-BOOKMARK-FILE") || upper.contains("<DL")) {
+        return Format::NetscapeHtml;
+    }
+    return Format::Unknown;
+}
+
+QString BrowserImporter::formatName(Format format)
+{
+    switch (format) {
+    case Format::NetscapeHtml:
+        return "书签 HTML";
+    case Format::ChromeJson:
+        return "Chrome";
+    case Format::FirefoxPlaces:
+        return "Firefox";
+    case Format::Unknown:
+        break;
+    }
+    return QString();
+}
+
+void BrowserImporter::cancel()
+{
+    m_cancelled.storeRelease(1);
+}
+
+bool BrowserImporter::isCancelled() const
+{
+    return m_cancelled.loadAcquire() != 0;
+}
+
+void BrowserImporter::acknowledgeBatch()
+{
+    m_credits.release();
+}
+
+void BrowserImporter::run()
+{
+    if (m_format == Format::Unknown) {
+        m_format = detectFormat(m_path);
+    }
+
+    QString error;
+    bool ok = false;
+    switch (m_format) {
+    case Format::NetscapeHtml:
+        ok = importNetscapeHtml(&error);
+        break;
+    case Format::ChromeJson:
+        ok = importChromeJson(&error);
+        break;
+    case Format::FirefoxPlaces:
+        ok = importFirefoxPlaces(&error);
+        break;
+    case Format::Unknown:
+        error = "无法识别的文件格式";
+        break;
+    }
+
+    ok = ok && flushBatch();
+
+    // 取消时 error 为空
+    if (isCancelled()) {
+        emit importFinished(false, QString());
+        return;
+    }
+    emit importFinished(ok, error);
+}
+
+bool BrowserImporter::importNetscapeHtml(QString *error)
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = file.errorString();
+        return false;
+    }
+
+    const qint64 total = file.size();
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    QString buffer;
+
+    // 每个 <DL> 对应一个文件夹；<H3> 之后的第一个 <DL> 属于这个文件夹
+    QStringList folderStack;
+    QString pendingFolder;
+    bool hasPendingFolder = false;
+
+    enum class Capture { None, Folder, Bookmark };
+    Capture capture = Capture::None;
+    QString text;
+    BookmarkFolder folder;
+    Bookmark bookmark;
+
+    auto appendText = [&](QStringView part) {
+        if (capture != Capture::None && text.size() < MAX_TEXT_LENGTH) {
+            text.append(part.left(MAX_TEXT_LENGTH - text.size()));
+        }
+    };
+    auto currentFolder = [&]() {
+        return folderStack.isEmpty() ? QString() : folderStack.last();
+    };
+    // 被块边界截断的标签留在 buffer 开头，其中 tagScanned 之前已经找过 '>'，下一块从这里继续找
+    qsizetype tagScanned = 0;
+
+    while (!file.atEnd()) {
+        buffer += decoder.decode(file.read(READ_CHUNK_SIZE));
+        reportProgress(file.pos(), total);
+
+        qsizetype pos = 0;
+        while (true) {
+            const qsizetype open = buffer.indexOf('<', pos);
+            if (open < 0) {
+                appendText(QStringView(buffer).mid(pos));
+                pos = buffer.size();
+                break;
+            }
+            const qsizetype close = buffer.indexOf('>', qMax(open + 1, tagScanned));
+            if (close < 0) {
+                // 标签被块边界截断，留到下一块
+                appendText(QStringView(buffer).mid(pos, open - pos));
+                pos = open;
+                break;
+            }
+            appendText(QStringView(buffer).mid(pos, open - pos));
+            pos = close + 1;
+
+            const QStringView tag = QStringView(buffer).mid(open + 1, close - open - 1);
+            qsizetype nameEnd = 0;
+            while (nameEnd < tag.size() && !tag[nameEnd].isSpace()) {
+                ++nameEnd;
+            }
+            const QStringView name = tag.left(nameEnd);
+
+            bool ok = true;
+            if (name.compare(u"H3", Qt::CaseInsensitive) == 0) {
+                capture = Capture::Folder;
+                text.clear();
+                folder = BookmarkFolder();
+                folder.setId(newId());
+                folder.setParentId(currentFolder());
+                folder.setDateAdded(fromUnixSeconds(tagAttribute(tag, u"ADD_DATE")));
+            } else if (name.compare(u"/H3", Qt::CaseInsensitive) == 0 && capture == Capture::Folder) {
+                capture = Capture::None;
+                folder.setTitle(decodeEntities(text).trimmed());
+                pendingFolder = folder.id();
+                hasPendingFolder = true;
+                ok = addFolder(folder);
+            } else if (name.compare(u"A", Qt::CaseInsensitive) == 0) {
+                capture = Capture::Bookmark;
+                text.clear();
+                bookmark = Bookmark();
+                bookmark.setId(newId());
+                bookmark.setUrl(tagAttribute(tag, u"HREF"));
+                bookmark.setParentId(currentFolder());
+                bookmark.setDateAdded(fromUnixSeconds(tagAttribute(tag, u"ADD_DATE")));
+            } else if (name.compare(u"/A", Qt::CaseInsensitive) == 0 && capture == Capture::Bookmark) {
+                capture = Capture::None;
+                // Firefox 导出的 place: 是智能书签查询，不是网页
+                if (!bookmark.url().isEmpty() && !bookmark.url().startsWith("place:")) {
+                    const QString title = decodeEntities(text).trimmed();
+                    bookmark.setTitle(title.isEmpty() ? bookmark.url() : title);
+                    ok = addBookmark(bookmark);
+                }
+            } else if (name.compare(u"DL", Qt::CaseInsensitive) == 0) {
+                folderStack.append(hasPendingFolder ? pendingFolder : currentFolder());
+                hasPendingFolder = false;
+            } else if (name.compare(u"/DL", Qt::CaseInsensitive) == 0) {
+                if (!folderStack.isEmpty()) {
+                    folderStack.removeLast();
+                }
+            }
+
+            if (!ok) {
+                return false;
+            }
+        }
+        buffer.remove(0, pos);
+        // 剩下的只可能是未结束的标签：只保留开头，缓冲区不随标签长度增长
+        if (buffer.size() > MAX_TAG_LENGTH) {
+            buffer.truncate(MAX_TAG_LENGTH);
+        }
+        tagScanned = buffer.size();
+    }
+    return !isCancelled();
+}
+
+bool BrowserImporter::importChromeJson(QString *error)
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = file.errorString();
+        return false;
+    }
+
+    // 每层对象或数组一个栈帧，只有书签节点的栈帧保存内容
+    struct Frame
+    {
+        bool isObject = false;
+        bool isRoots = false;       // "roots" 对象，其中每个值是一个顶层文件夹
+        bool isChildren = false;    // 节点的 "children" 数组
+        bool isNode = false;
+        QString key;                // 对象中最近读到的键
+        QString id;
+        QString parentId;
+        QString name;
+        QString type;
+        QString url;
+        QString dateAdded;
+        bool folderEmitted = false;
+        QString emittedName;
+    };
+
+    // Chrome 按键名排序写出，"children" 在 "name" 之前：
+    // 读到子数组时先交出名称为空的文件夹，保证子项的父文件夹已经存在，读完节点后再补上名称
+    auto emitFolder = [this](Frame &frame) {
+        BookmarkFolder folder;
+        folder.setId(frame.id);
+        folder.setTitle(frame.name);
+        folder.setParentId(frame.parentId);
+        folder.setDateAdded(fromChromeTime(frame.dateAdded));
+        frame.folderEmitted = true;
+        frame.emittedName = frame.name;
+        return addFolder(folder);
+    };
+
+    const qint64 total = file.size();
+    JsonStreamReader reader(&file, READ_CHUNK_SIZE);
+    QList<Frame> stack;
+    int tokens = 0;
+
+    while (true) {
+        const JsonStreamReader::Token token = reader.next();
+        if (token == JsonStreamReader::EndOfData) {
+            break;
+        }
+        if (token == JsonStreamReader::Invalid) {
+            *error = "书签文件格式错误";
+            return false;
+        }
+        if (++tokens % 1024 == 0) {
+            reportProgress(reader.position(), total);
+            if (isCancelled()) {
+                return false;
+            }
+        }
+
+        bool ok = true;
+        switch (token) {
+        case JsonStreamReader::Key:
+            if (!stack.isEmpty()) {
+                stack.last().key = reader.text();
+            }
+            break;
+        case JsonStreamReader::ObjectStart:
+        case JsonStreamReader::ArrayStart: {
+            Frame frame;
+            frame.isObject = token == JsonStreamReader::ObjectStart;
+            if (!stack.isEmpty()) {
+                Frame &parent = stack.last();
+                if (frame.isObject) {
+                    frame.isNode = parent.isRoots || parent.isChildren;
+                    frame.isRoots = stack.size() == 1 && parent.key == "roots";
+                } else if (parent.isNode && parent.key == "children") {
+                    frame.isChildren = true;
+                    if (!parent.folderEmitted) {
+                        ok = emitFolder(parent);
+                    }
+                }
+            }
+            if (frame.isNode) {
+                frame.id = newId();
+                for (qsizetype i = stack.size() - 1; i >= 0; --i) {
+                    if (stack[i].isNode) {
+                        frame.parentId = stack[i].id;
+                        break;
+                    }
+                }
+            }
+            stack.append(frame);
+            break;
+        }
+        case JsonStreamReader::ObjectEnd:
+        case JsonStreamReader::ArrayEnd: {
+            if (stack.isEmpty()) {
+                *error = "书签文件格式错误";
+                return false;
+            }
+            Frame frame = stack.takeLast();
+            if (!frame.isNode) {
+                break;
+            }
+            if (frame.type == "url") {
+                if (!frame.url.isEmpty()) {
+                    Bookmark bookmark;
+                    bookmark.setId(frame.id);
+                    bookmark.setTitle(frame.name.isEmpty() ? frame.url : frame.name);
+                    bookmark.setUrl(frame.url);
+                    bookmark.setParentId(frame.parentId);
+                    bookmark.setDateAdded(fromChromeTime(frame.dateAdded));
+                    ok = addBookmark(bookmark);
+                }
+            } else if (!frame.folderEmitted || frame.emittedName != frame.name) {
+                ok = emitFolder(frame);
+            }
+            break;
+        }
+        case JsonStreamReader::String:
+        case JsonStreamReader::Number:
+        case JsonStreamReader::Literal:
+            if (!stack.isEmpty() && stack.last().isNode) {
+                Frame &frame = stack.last();
+                if (frame.key == "name") {
+                    frame.name = reader.text().left(MAX_TEXT_LENGTH);
+                } else if (frame.key == "type") {
+                    frame.type = reader.text();
+                } else if (frame.key == "url") {
+                    frame.url = reader.text();
+                } else if (frame.key == "date_added") {
+                    frame.dateAdded = reader.text();
+                }
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (!ok) {
+            return false;
+        }
+    }
+
+    if (!stack.isEmpty()) {
+        *error = "书签文件不完整";
+        return false;
+    }
+    return !isCancelled();
+}
+
+bool BrowserImporter::importFirefoxPlaces(QString *error)
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    const QString connectionName = QString("browser-import-%1").arg(quintptr(this));
+    bool ok = false;
+    {
+        // Firefox 运行时会锁住数据库，只读打开，忙时稍等
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(m_path);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=2000");
+        if (!db.open()) {
+            *error = "无法打开 places.sqlite，请先关闭 Firefox: " + db.lastError().text();
+        } else {
+            ok = readFirefoxPlaces(db, error);
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+#else
+    *error = "此版本未启用 SQLite 支持，无法导入 Firefox 数据";
+    return false;
+#endif
+}
+
+#ifdef WINBROWSER_HAS_SQLITE
+bool BrowserImporter::readFirefoxPlaces(QSqlDatabase &db, QString *error)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    qint64 total = 0;
+    if (query.exec("SELECT (SELECT COUNT(*) FROM moz_bookmarks WHERE type = 1) "
+                   "+ (SELECT COUNT(*) FROM moz_places WHERE visit_count > 0)") && query.next()) {
+        total = query.value(0).toLongLong();
+    }
+
+    // 文件夹数量很少，先全部读入，再从根开始按父文件夹在前的顺序交出；标签文件夹不是书签，跳过
+    struct Folder
+    {
+        qint64 id;
+        QString guid;
+        QString title;
+        qint64 dateAdded;
+    };
+    QHash<qint64, QList<Folder>> childFolders;
+    qint64 rootId = -1;
+    if (!query.exec("SELECT id, parent, guid, title, dateAdded FROM moz_bookmarks "
+                    "WHERE type = 2 ORDER BY parent, position")) {
+        *error = "读取 Firefox 书签失败: " + query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        Folder folder{query.value(0).toLongLong(), query.value(2).toString(),
+                      query.value(3).toString(), query.value(4).toLongLong()};
+        if (folder.guid == "root________") {
+            rootId = folder.id;
+        }
+        childFolders[query.value(1).toLongLong()].append(folder);
+    }
+
+    static const QHash<QString, QString> rootTitles = {
+        {"menu________", "书签菜单"},
+        {"toolbar_____", "书签工具栏"},
+        {"unfiled_____", "其他书签"},
+        {"mobile______", "移动设备书签"},
+    };
+
+    QHash<qint64, QString> folderIds;
+    folderIds.insert(rootId, QString());
+    QList<qint64> level{rootId};
+    while (!level.isEmpty()) {
+        QList<qint64> next;
+        for (qint64 parent : std::as_const(level)) {
+            for (const Folder &child : childFolders.value(parent)) {
+                if (child.guid == "tags________" || folderIds.contains(child.id)) {
+                    continue;
+                }
+                BookmarkFolder folder;
+                folder.setId(newId());
+                folder.setTitle(rootTitles.value(child.guid, child.title));
+                folder.setParentId(folderIds.value(parent));
+                folder.setDateAdded(fromFirefoxTime(child.dateAdded));
+                folderIds.insert(child.id, folder.id());
+                next.append(child.id);
+                if (!addFolder(folder)) {
+                    return false;
+                }
+            }
+        }
+        level = next;
+    }
+    childFolders.clear();
+
+    // 书签和历史记录都逐行读取
+    qint64 done = 0;
+    if (!query.exec("SELECT b.parent, b.title, b.dateAdded, p.url FROM moz_bookmarks b "
+                    "JOIN moz_places p ON p.id = b.fk WHERE b.type = 1 ORDER BY b.parent, b.position")) {
+        *error = "读取 Firefox 书签失败: " + query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        reportProgress(++done, total);
+        auto parent = folderIds.constFind(query.value(0).toLongLong());
+        const QString url = query.value(3).toString();
+        if (parent == folderIds.constEnd() || url.isEmpty() || url.startsWith("place:")) {
+            continue;
+        }
+
+        Bookmark bookmark;
+        bookmark.setId(newId());
+        bookmark.setTitle(query.value(1).toString().isEmpty() ? url : query.value(1).toString());
+        bookmark.setUrl(url);
+        bookmark.setParentId(parent.value());
+        bookmark.setDateAdded(fromFirefoxTime(query.value(2).toLongLong()));
+        if (!addBookmark(bookmark)) {
+            return false;
+        }
+    }
+
+    if (!query.exec("SELECT url, title, visit_count, last_visit_date FROM moz_places "
+                    "WHERE visit_count > 0")) {
+        *error = "读取 Firefox 历史记录失败: " + query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        reportProgress(++done, total);
+        HistoryItem item;
+        item.setId(newId());
+        item.setUrl(query.value(0).toString());
+        item.setTitle(query.value(1).toString().isEmpty() ? item.url() : query.value(1).toString());
+        item.setVisitCount(query.value(2).toInt());
+        item.setTimestamp(fromFirefoxTime(query.value(3).toLongLong()));
+        if (!addHistory(item)) {
+            return false;
+        }
+    }
+    return !isCancelled();
+}
+#endif
+
+bool BrowserImporter::addFolder(const BookmarkFolder &folder)
+{
+    m_batch.folders.append(folder);
+    return m_batch.size() < BATCH_SIZE ? !isCancelled() : flushBatch();
+}
+
+bool BrowserImporter::addBookmark(const Bookmark &bookmark)
+{
+    m_batch.bookmarks.append(bookmark);
+    return m_batch.size() < BATCH_SIZE ? !isCancelled() : flushBatch();
+}
+
+bool BrowserImporter::addHistory(const HistoryItem &item)
+{
+    m_batch.history.append(item);
+    return m_batch.size() < BATCH_SIZE ? !isCancelled() : flushBatch();
+}
+
+bool BrowserImporter::flushBatch()
+{
+    if (m_batch.isEmpty()) {
+        return !isCancelled();
+    }
+
+    // 界面线程来不及处理时在这里等待，避免批次在事件队列中堆积
+    while (!m_credits.tryAcquire(1, 50)) {
+        if (isCancelled()) {
+            return false;
+        }
+    }
+    if (isCancelled()) {
+        return false;
+    }
+
+    emit batchReady(m_batch);
+    m_batch = ImportBatch();
+    return true;
+}
+
+void BrowserImporter::reportProgress(qint64 done, qint64 total)
+{
+    // 只在千分比变化时发出，避免大量跨线程信号
+    const int permille = total > 0 ? int(qMin<qint64>(done, total) * 1000 / total) : 0;
+    if (permille != m_lastPermille) {
+        m_lastPermille = permille;
+        emit progress(done, total);
+    }
+}
+
+} // namespace WinBrowserQt
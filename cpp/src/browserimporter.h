@@ -0,0 +1,100 @@
+#ifndef BROWSERIMPORTER_H
+#define BROWSERIMPORTER_H
+
+#include <QThread>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <QList>
+#include <QString>
+#include "models/bookmark.h"
+#include "models/bookmarkfolder.h"
+#include "models/historyitem.h"
+
+#ifdef WINBROWSER_HAS_SQLITE
+class QSqlDatabase;
+#endif
+
+namespace WinBrowserQt {
+
+// 导入线程交给界面线程的一批记录
+// 父文件夹总是先于其中的书签和子文件夹出现；同一个文件夹 id 再次出现表示更新标题
+// parentId 为空表示位于导入的根文件夹下，由调用方决定放到哪里
+struct ImportBatch
+{
+    QList<BookmarkFolder> folders;
+    QList<Bookmark> bookmarks;
+    QList<HistoryItem> history;
+
+    int size() const { return int(folders.size() + bookmarks.size() + history.size()); }
+    bool isEmpty() const { return size() == 0; }
+};
+
+// 从其他浏览器导入书签和历史记录：Netscape 书签 HTML、Chrome 的 Bookmarks JSON、Firefox 的 places.sqlite
+// 在独立线程中流式解析，文件按固定大小的块读取，每解析出 BATCH_SIZE 条记录就通过 batchReady 交给界面线程
+// 界面线程处理完一批后调用 acknowledgeBatch()；在途批次达到 MAX_PENDING_BATCHES 时解析线程等待，
+// 因此内存占用只与批次大小有关，与文件大小无关
+class BrowserImporter : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum class Format {
+        Unknown,
+        NetscapeHtml,
+        ChromeJson,
+        FirefoxPlaces
+    };
+
+    explicit BrowserImporter(const QString &path, Format format = Format::Unknown, QObject *parent = nullptr);
+    ~BrowserImporter();
+
+    // 按文件头判断格式
+    static Format detectFormat(const QString &path);
+    static QString formatName(Format format);
+
+    Format format() const { return m_format; }
+
+    // 可在任意线程调用；已经交出的批次不会撤回
+    void cancel();
+    bool isCancelled() const;
+    void acknowledgeBatch();
+
+signals:
+    void batchReady(const WinBrowserQt::ImportBatch &batch);
+    // done / total 的单位由格式决定（字节数或记录数），只用于显示进度
+    void progress(qint64 done, qint64 total);
+    void importFinished(bool ok, const QString &error);
+
+protected:
+    void run() override;
+
+private:
+    bool importNetscapeHtml(QString *error);
+    bool importChromeJson(QString *error);
+    bool importFirefoxPlaces(QString *error);
+#ifdef WINBROWSER_HAS_SQLITE
+    bool readFirefoxPlaces(QSqlDatabase &db, QString *error);
+#endif
+
+    // 返回 false 表示已取消
+    bool addFolder(const BookmarkFolder &folder);
+    bool addBookmark(const Bookmark &bookmark);
+    bool addHistory(const HistoryItem &item);
+    bool flushBatch();
+    void reportProgress(qint64 done, qint64 total);
+
+    QString m_path;
+    Format m_format;
+    QAtomicInt m_cancelled;
+    QSemaphore m_credits;
+    ImportBatch m_batch;
+    int m_lastPermille;
+
+    static const int BATCH_SIZE = 500;
+    static const int MAX_PENDING_BATCHES = 4;
+    static const int READ_CHUNK_SIZE = 64 * 1024;
+};
+
+} // namespace WinBrowserQt
+
+#endif // BROWSERIMPORTER_H
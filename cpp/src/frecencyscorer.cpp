@@ -0,0 +1,102 @@
+#include "frecencyscorer.h"
+#include <cmath>
+#include <limits>
+
+namespace WinBrowserQt {
+
+namespace {
+
+const double DECAY_PER_MS = std::log(2.0) / double(FrecencyScorer::HALF_LIFE_MS);
+const qint64 DAY_MS = 24LL * 60 * 60 * 1000;
+
+} // namespace
+
+FrecencyScorer::FrecencyScorer()
+{
+}
+
+void FrecencyScorer::clear()
+{
+    m_entries.clear();
+}
+
+void FrecencyScorer::remove(const QString &historyId)
+{
+    m_entries.remove(historyId);
+}
+
+void FrecencyScorer::addVisits(const QString &historyId, int visitCount, qint64 lastVisitMSecs, qint64 nowMSecs)
+{
+    // 访问时间段的权重已经体现了新近程度，以当前时刻为衰减起点
+    const double weight = double(qMax(1, visitCount)) * bucketWeight(nowMSecs - lastVisitMSecs);
+    addWeight(historyId, weight, nowMSecs);
+}
+
+void FrecencyScorer::recordVisit(const QString &historyId, qint64 whenMSecs, bool typed)
+{
+    addWeight(historyId, typed ? VISIT_WEIGHT * TYPED_BOOST : VISIT_WEIGHT, whenMSecs);
+}
+
+void FrecencyScorer::setBookmarked(const QString &historyId, bool bookmarked)
+{
+    auto it = m_entries.find(historyId);
+    if (it != m_entries.end()) {
+        it->bookmarked = bookmarked;
+    }
+}
+
+double FrecencyScorer::rank(const QString &historyId) const
+{
+    auto it = m_entries.constFind(historyId);
+    if (it == m_entries.constEnd()) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    return it->bookmarked ? it->logScore + std::log(BOOKMARK_BOOST) : it->logScore;
+}
+
+double FrecencyScorer::score(const QString &historyId, qint64 nowMSecs) const
+{
+    return std::exp(rank(historyId) - DECAY_PER_MS * double(nowMSecs));
+}
+
+double FrecencyScorer::bookmarkRank(qint64 dateAddedMSecs)
+{
+    return std::log(double(VISIT_WEIGHT)) + DECAY_PER_MS * double(dateAddedMSecs) + std::log(BOOKMARK_BOOST);
+}
+
+void FrecencyScorer::addWeight(const QString &historyId, double weight, qint64 atMSecs)
+{
+    // 权重换算到时间原点：w × e^(λt) 取对数，避免指数溢出
+    const double term = std::log(weight) + DECAY_PER_MS * double(atMSecs);
+
+    auto it = m_entries.find(historyId);
+    if (it == m_entries.end()) {
+        Entry entry;
+        entry.logScore = term;
+        m_entries.insert(historyId, entry);
+        return;
+    }
+
+    const double high = qMax(it->logScore, term);
+    const double low = qMin(it->logScore, term);
+    it->logScore = high + std::log1p(std::exp(low - high));
+}
+
+int FrecencyScorer::bucketWeight(qint64 ageMSecs)
+{
+    if (ageMSecs <= 4 * DAY_MS) {
+        return 100;
+    }
+    if (ageMSecs <= 14 * DAY_MS) {
+        return 70;
+    }
+    if (ageMSecs <= 31 * DAY_MS) {
+        return 50;
+    }
+    if (ageMSecs <= 90 * DAY_MS) {
+        return 30;
+    }
+    return 10;
+}
+
+} // namespace WinBrowserQt
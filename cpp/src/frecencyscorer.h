@@ -0,0 +1,56 @@
+#ifndef FRECENCYSCORER_H
+#define FRECENCYSCORER_H
+
+#include <QString>
+#include <QHash>
+
+namespace WinBrowserQt {
+
+// 历史记录的 frecency（访问频率 × 新近程度）评分，按历史记录 id 增量维护
+// - 每次访问贡献一个权重（地址栏输入的访问加倍），权重随时间按半衰期指数衰减
+// - 衰减是惰性的：分数保存为以固定时间原点为基准的对数值 ln(Σ 权重 × e^(λ·访问时间))，
+//   所有记录共用同一个原点，排序只比较这个值，不需要随时间重新计算；新访问用 log-sum-exp 累加
+// - 已持久化的记录只有访问次数和最后访问时间，载入时按最后访问时间所在的时间段估算初始权重
+// - 书签加成在排序时叠加，书签变化不改动分数
+class FrecencyScorer
+{
+public:
+    FrecencyScorer();
+
+    void clear();
+    void remove(const QString &historyId);
+
+    // 合并 visitCount 次最后发生在 lastVisitMSecs 的访问（载入或导入），按时间段估算权重
+    void addVisits(const QString &historyId, int visitCount, qint64 lastVisitMSecs, qint64 nowMSecs);
+    // 记录一次刚发生的访问
+    void recordVisit(const QString &historyId, qint64 whenMSecs, bool typed);
+    void setBookmarked(const QString &historyId, bool bookmarked);
+
+    // 排序键：值越大越靠前，没有记录时为负无穷
+    double rank(const QString &historyId) const;
+    // 当前时刻的 frecency 值，用于显示或调试
+    double score(const QString &historyId, qint64 nowMSecs) const;
+    // 没有访问记录的书签：把添加书签视为一次访问，并叠加书签加成
+    static double bookmarkRank(qint64 dateAddedMSecs);
+
+    static const int VISIT_WEIGHT = 100;
+    static constexpr double TYPED_BOOST = 2.0;
+    static constexpr double BOOKMARK_BOOST = 1.4;
+    static const qint64 HALF_LIFE_MS = 30LL * 24 * 60 * 60 * 1000;
+
+private:
+    struct Entry
+    {
+        double logScore;
+        bool bookmarked = false;
+    };
+
+    void addWeight(const QString &historyId, double weight, qint64 atMSecs);
+    static int bucketWeight(qint64 ageMSecs);
+
+    QHash<QString, Entry> m_entries;
+};
+
+} // namespace WinBrowserQt
+
+#endif // FRECENCYSCORER_H
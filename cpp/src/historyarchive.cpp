@@ -0,0 +1,357 @@
+#include "historyarchive.h"
+#include "binarystore.h"
+#include "textmatcher.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QSet>
+#include <QMutexLocker>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace WinBrowserQt {
+
+namespace {
+
+const char SEGMENT_MAGIC[4] = { 'W', 'B', 'H', 'A' };
+// 版本 2 的过滤器按 QChar::toCaseFolded 折叠取 trigram，与 TextMatcher 一致；
+// 版本 1 按 toLower 取 trigram，个别字符（ſ、ς 等）两者结果不同，查询时不使用它的过滤器
+const quint32 SEGMENT_VERSION = 2;
+const quint32 SEGMENT_LOWERCASE_FILTER_VERSION = 1;
+const qint64 SEGMENT_HEADER_SIZE = 48;
+
+// 每个 trigram 约 10 位、7 个哈希函数时误判率约 1%
+const int BLOOM_BITS_PER_ENTRY = 10;
+const quint32 BLOOM_HASH_COUNT = 7;
+const int BLOOM_MIN_BITS = 512;
+
+// 过滤器随段文件一起持久化，必须使用跨平台、跨进程稳定的哈希（qHash 带随机种子）；
+// 字符按与 TextMatcher 相同的规则（逐个 UTF-16 码元简单大小写折叠）折叠后再哈希
+quint64 trigramHash(const QChar *chars)
+{
+    quint64 hash = 14695981039346656037ULL;
+    for (int i = 0; i < 3; ++i) {
+        hash ^= chars[i].toCaseFolded().unicode();
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void collectTrigrams(const QString &text, QSet<quint64> *hashes)
+{
+    for (qsizetype i = 0; i + 3 <= text.size(); ++i) {
+        hashes->insert(trigramHash(text.constData() + i));
+    }
+}
+
+// 双重哈希：第 i 个位置为 h1 + i * h2
+quint32 bloomBit(quint64 hash, quint32 i, quint32 bitCount)
+{
+    const quint32 h1 = quint32(hash);
+    const quint32 h2 = quint32(hash >> 32) | 1;
+    return (h1 + i * h2) % bitCount;
+}
+
+// 直接在解压后的记录上比较，只读取时间和 URL、标题的视图，不解码其他字段
+bool matches(const MappedHistoryFile &records, int index, const TextMatcher &matcher, qint64 from, qint64 to)
+{
+    if (from != std::numeric_limits<qint64>::min() || to != std::numeric_limits<qint64>::max()) {
+        const qint64 msecs = records.timestampMSecs(index);
+        if (msecs == std::numeric_limits<qint64>::min() || msecs < from || msecs > to) {
+            return false;
+        }
+    }
+    return matcher.isEmpty() || matcher.matches(records.urlView(index)) || matcher.matches(records.titleView(index));
+}
+
+} // namespace
+
+HistoryArchive::HistoryArchive(const QString &directory)
+    : m_directory(directory)
+    , m_generation(0)
+{
+}
+
+void HistoryArchive::load()
+{
+    QDir dir(m_directory);
+    QList<Segment> segments;
+    for (const QString &name : dir.entryList(QStringList() << "*.seg", QDir::Files)) {
+        Segment segment;
+        if (readHeader(dir.filePath(name), &segment)) {
+            segments.append(segment);
+        }
+    }
+
+    std::sort(segments.begin(), segments.end(), [](const Segment &a, const Segment &b) {
+        return a.maxTimestamp < b.maxTimestamp;
+    });
+
+    QMutexLocker locker(&m_mutex);
+    m_segments = segments;
+}
+
+int HistoryArchive::generation() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+bool HistoryArchive::writeSegment(const QList<HistoryItem> &items, int generation)
+{
+    if (items.isEmpty()) {
+        return true;
+    }
+
+    Segment segment;
+    segment.count = int(items.size());
+    segment.minTimestamp = std::numeric_limits<qint64>::max();
+    segment.maxTimestamp = std::numeric_limits<qint64>::min();
+
+    QSet<quint64> trigrams;
+    for (const auto &item : items) {
+        if (item.timestamp().isValid()) {
+            const qint64 msecs = item.timestamp().toMSecsSinceEpoch();
+            segment.minTimestamp = qMin(segment.minTimestamp, msecs);
+            segment.maxTimestamp = qMax(segment.maxTimestamp, msecs);
+        }
+        collectTrigrams(item.url(), &trigrams);
+        collectTrigrams(item.title(), &trigrams);
+    }
+    if (segment.minTimestamp > segment.maxTimestamp) {
+        segment.minTimestamp = segment.maxTimestamp = 0;
+    }
+
+    const quint32 bitCount = quint32(qMax(BLOOM_MIN_BITS, int(trigrams.size()) * BLOOM_BITS_PER_ENTRY) + 7) & ~7u;
+    segment.hashCount = BLOOM_HASH_COUNT;
+    segment.bloom = QByteArray(bitCount / 8, '\0');
+    uchar *bits = reinterpret_cast<uchar *>(segment.bloom.data());
+    for (quint64 hash : std::as_const(trigrams)) {
+        for (quint32 i = 0; i < BLOOM_HASH_COUNT; ++i) {
+            const quint32 bit = bloomBit(hash, i, bitCount);
+            bits[bit / 8] |= uchar(1u << (bit % 8));
+        }
+    }
+
+    const QByteArray payload = qCompress(BinaryStore::serializeHistory(items));
+
+    QByteArray header(SEGMENT_HEADER_SIZE, '\0');
+    uchar *h = reinterpret_cast<uchar *>(header.data());
+    std::memcpy(h, SEGMENT_MAGIC, 4);
+    qToLittleEndian<quint32>(SEGMENT_VERSION, h + 4);
+    qToLittleEndian<quint32>(quint32(segment.count), h + 8);
+    qToLittleEndian<quint32>(segment.hashCount, h + 12);
+    qToLittleEndian<qint64>(segment.minTimestamp, h + 16);
+    qToLittleEndian<qint64>(segment.maxTimestamp, h + 24);
+    qToLittleEndian<quint32>(quint32(segment.bloom.size()), h + 32);
+    qToLittleEndian<quint64>(quint64(payload.size()), h + 40);
+
+    segment.payloadOffset = SEGMENT_HEADER_SIZE + segment.bloom.size();
+    segment.payloadSize = payload.size();
+
+    QMutexLocker locker(&m_mutex);
+    if (generation != m_generation) {
+        // 调度之后归档被清空，这批记录已经不应存在
+        return true;
+    }
+
+    if (!QDir().mkpath(m_directory)) {
+        qWarning() << "创建历史记录归档目录失败:" << m_directory;
+        return false;
+    }
+
+    int suffix = 0;
+    do {
+        segment.path = QString("%1/%2-%3.seg").arg(m_directory).arg(segment.maxTimestamp).arg(suffix++);
+    } while (QFile::exists(segment.path));
+
+    QSaveFile file(segment.path);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(header) != header.size()
+        || file.write(segment.bloom) != segment.bloom.size()
+        || file.write(payload) != payload.size()
+        || !file.commit()) {
+        qWarning() << "写入历史记录归档段失败:" << segment.path << file.errorString();
+        return false;
+    }
+
+    auto it = std::upper_bound(m_segments.begin(), m_segments.end(), segment.maxTimestamp,
+                               [](qint64 value, const Segment &s) { return value < s.maxTimestamp; });
+    m_segments.insert(it, segment);
+    return true;
+}
+
+void HistoryArchive::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_generation;
+    for (const auto &segment : std::as_const(m_segments)) {
+        QFile::remove(segment.path);
+    }
+    m_segments.clear();
+}
+
+int HistoryArchive::segmentCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return int(m_segments.size());
+}
+
+qint64 HistoryArchive::itemCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 count = 0;
+    for (const auto &segment : m_segments) {
+        count += segment.count;
+    }
+    return count;
+}
+
+QList<HistoryItem> HistoryArchive::search(const QString &query, const QDateTime &from,
+                                          const QDateTime &to, int limit) const
+{
+    QList<HistoryItem> results;
+    const QString trimmedQuery = query.trimmed();
+    const TextMatcher matcher(trimmedQuery);
+    const qint64 fromMSecs = from.isValid() ? from.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    const qint64 toMSecs = to.isValid() ? to.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+
+    // 段列表只在锁内复制（过滤器是隐式共享的），解压扫描在锁外进行
+    QList<Segment> segments;
+    {
+        QMutexLocker locker(&m_mutex);
+        segments = m_segments;
+    }
+
+    QSet<QString> seen;
+    for (auto it = segments.crbegin(); it != segments.crend() && results.size() < limit; ++it) {
+        const Segment &segment = *it;
+        if (segment.maxTimestamp < fromMSecs || segment.minTimestamp > toMSecs) {
+            continue;
+        }
+        if (!mayContain(segment, trimmedQuery)) {
+            continue;
+        }
+
+        MappedHistoryFile records;
+        if (!openRecords(segment, &records)) {
+            continue;
+        }
+        // 只有命中的记录才解码为 HistoryItem
+        for (int i = records.count() - 1; i >= 0 && results.size() < limit; --i) {
+            if (!matches(records, i, matcher, fromMSecs, toMSecs)) {
+                continue;
+            }
+            // 压缩中途崩溃时同一条记录可能出现在两个段中
+            const QString id = records.id(i);
+            if (!seen.contains(id)) {
+                seen.insert(id);
+                results.append(records.itemAt(i));
+            }
+        }
+    }
+
+    return results;
+}
+
+QList<HistoryItem> HistoryArchive::items() const
+{
+    QList<Segment> segments;
+    {
+        QMutexLocker locker(&m_mutex);
+        segments = m_segments;
+    }
+
+    QList<HistoryItem> history;
+    QSet<QString> seen;
+    for (const auto &segment : std::as_const(segments)) {
+        MappedHistoryFile records;
+        if (!openRecords(segment, &records)) {
+            continue;
+        }
+        for (int i = 0; i < records.count(); ++i) {
+            const QString id = records.id(i);
+            if (!seen.contains(id)) {
+                seen.insert(id);
+                history.append(records.itemAt(i));
+            }
+        }
+    }
+    return history;
+}
+
+bool HistoryArchive::readHeader(const QString &path, Segment *segment) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QByteArray header = file.read(SEGMENT_HEADER_SIZE);
+    if (header.size() != SEGMENT_HEADER_SIZE) {
+        return false;
+    }
+
+    const uchar *h = reinterpret_cast<const uchar *>(header.constData());
+    const quint32 bloomSize = qFromLittleEndian<quint32>(h + 32);
+    const quint64 payloadSize = qFromLittleEndian<quint64>(h + 40);
+    const quint32 version = qFromLittleEndian<quint32>(h + 4);
+    if (std::memcmp(h, SEGMENT_MAGIC, 4) != 0
+        || (version != SEGMENT_VERSION && version != SEGMENT_LOWERCASE_FILTER_VERSION)
+        || bloomSize == 0
+        || quint64(SEGMENT_HEADER_SIZE) + bloomSize + payloadSize != quint64(file.size())) {
+        qWarning() << "历史记录归档段格式不匹配:" << path;
+        return false;
+    }
+
+    segment->path = path;
+    segment->count = int(qFromLittleEndian<quint32>(h + 8));
+    segment->hashCount = qFromLittleEndian<quint32>(h + 12);
+    segment->foldedFilter = version == SEGMENT_VERSION;
+    segment->minTimestamp = qFromLittleEndian<qint64>(h + 16);
+    segment->maxTimestamp = qFromLittleEndian<qint64>(h + 24);
+    segment->bloom = file.read(bloomSize);
+    segment->payloadOffset = SEGMENT_HEADER_SIZE + bloomSize;
+    segment->payloadSize = qint64(payloadSize);
+    return segment->bloom.size() == qsizetype(bloomSize);
+}
+
+bool HistoryArchive::openRecords(const Segment &segment, MappedHistoryFile *records) const
+{
+    QFile file(segment.path);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(segment.payloadOffset)) {
+        return false;
+    }
+
+    if (!records->openData(qUncompress(file.read(segment.payloadSize)))) {
+        qWarning() << "读取历史记录归档段失败:" << segment.path;
+        return false;
+    }
+    return true;
+}
+
+bool HistoryArchive::mayContain(const Segment &segment, const QString &query)
+{
+    // 少于三个字符的查询没有 trigram，旧版本的过滤器与匹配的折叠规则不一致，都无法用来排除
+    if (query.size() < 3 || !segment.foldedFilter) {
+        return true;
+    }
+
+    const quint32 bitCount = quint32(segment.bloom.size()) * 8;
+    const uchar *bits = reinterpret_cast<const uchar *>(segment.bloom.constData());
+    for (qsizetype i = 0; i + 3 <= query.size(); ++i) {
+        const quint64 hash = trigramHash(query.constData() + i);
+        for (quint32 k = 0; k < segment.hashCount; ++k) {
+            const quint32 bit = bloomBit(hash, k, bitCount);
+            if (!(bits[bit / 8] & (1u << (bit % 8)))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,75 @@
+#ifndef HISTORYARCHIVE_H
+#define HISTORYARCHIVE_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include <QDateTime>
+#include <QMutex>
+#include "models/historyitem.h"
+
+namespace WinBrowserQt {
+
+class MappedHistoryFile;
+
+// 冷历史记录归档：超出热窗口的历史记录按时间分段压缩存放，段文件写入后不再修改
+//
+// 段文件格式（小端）：
+//   文件头   magic[4] | version u32 | recordCount u32 | hashCount u32 |
+//            minTimestamp i64 | maxTimestamp i64 | bloomSize u32 | 保留 u32 | payloadSize u64
+//   过滤器   bloomSize 字节的 trigram Bloom 过滤器（URL 和标题按大小写折叠后的所有三字符子串）
+//   数据     qCompress 压缩的历史记录二进制文件（见 BinaryStore）
+//
+// 内存中只保留每个段的头部和过滤器；查询时按时间范围和过滤器跳过不可能命中的段，
+// 其余段临时解压扫描后立即释放，因此内存占用不随归档的年数增长
+// 写入在存储写入线程中进行，查询在界面线程中进行，段列表由互斥锁保护
+class HistoryArchive
+{
+public:
+    explicit HistoryArchive(const QString &directory);
+
+    // 读取所有段的头部和过滤器，不解压数据
+    void load();
+
+    // 代数在每次 clear() 后递增；写入时代数已过期说明数据在调度后被清空，不再写入
+    int generation() const;
+    bool writeSegment(const QList<HistoryItem> &items, int generation);
+    void clear();
+
+    int segmentCount() const;
+    qint64 itemCount() const;
+
+    // 不区分大小写的子串查询，from/to 无效时表示不限；较新的段优先，最多返回 limit 条
+    QList<HistoryItem> search(const QString &query, const QDateTime &from,
+                              const QDateTime &to, int limit) const;
+    // 按时间顺序返回全部归档记录，用于导出
+    QList<HistoryItem> items() const;
+
+private:
+    struct Segment
+    {
+        QString path;
+        int count = 0;
+        qint64 minTimestamp = 0;
+        qint64 maxTimestamp = 0;
+        quint32 hashCount = 0;
+        bool foldedFilter = true;   // 过滤器与 TextMatcher 的折叠规则一致，可以用来排除
+        QByteArray bloom;
+        qint64 payloadOffset = 0;
+        qint64 payloadSize = 0;
+    };
+
+    bool readHeader(const QString &path, Segment *segment) const;
+    // 把段的数据解压到 records 中，字段在访问时才解码
+    bool openRecords(const Segment &segment, MappedHistoryFile *records) const;
+    static bool mayContain(const Segment &segment, const QString &query);
+
+    QString m_directory;
+    mutable QMutex m_mutex;
+    QList<Segment> m_segments;      // 按 maxTimestamp 升序
+    int m_generation;
+};
+
+} // namespace WinBrowserQt
+
+#endif // HISTORYARCHIVE_H
@@ -0,0 +1,55 @@
+#include "historychanges.h"
+
+namespace WinBrowserQt {
+
+void HistoryChangeBatch::record(HistoryChangeType type, const HistoryItem &item)
+{
+    if (type == HistoryChangeType::Cleared) {
+        m_changes.clear();
+        m_indexById.clear();
+        m_cleared = true;
+        return;
+    }
+
+    auto it = m_indexById.constFind(item.id());
+    if (it == m_indexById.constEnd()) {
+        m_indexById.insert(item.id(), int(m_changes.size()));
+        m_changes.append({type, item});
+        return;
+    }
+
+    const int index = it.value();
+    Change &change = m_changes[index];
+    switch (change.type) {
+    case HistoryChangeType::Added:
+        if (type == HistoryChangeType::Removed) {
+            // 批次之外从未见过这条记录
+            drop(index);
+            return;
+        }
+        break;
+    case HistoryChangeType::Updated:
+        change.type = type == HistoryChangeType::Removed ? HistoryChangeType::Removed : HistoryChangeType::Updated;
+        break;
+    case HistoryChangeType::Removed:
+        change.type = type == HistoryChangeType::Removed ? HistoryChangeType::Removed : HistoryChangeType::Updated;
+        break;
+    case HistoryChangeType::Cleared:
+        break;
+    }
+    change.item = item;
+}
+
+void HistoryChangeBatch::drop(int index)
+{
+    // 与最后一项交换后删除，O(1)；顺序本来就没有意义
+    m_indexById.remove(m_changes[index].item.id());
+    const int last = int(m_changes.size()) - 1;
+    if (index != last) {
+        m_changes[index] = m_changes[last];
+        m_indexById[m_changes[index].item.id()] = index;
+    }
+    m_changes.removeLast();
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,48 @@
+#ifndef HISTORYCHANGES_H
+#define HISTORYCHANGES_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include "models/historyitem.h"
+
+namespace WinBrowserQt {
+
+enum class HistoryChangeType {
+    Added,
+    Updated,
+    Removed,
+    Cleared
+};
+
+// 一段时间内的历史记录变化，按 id 合并后每条记录只保留最终状态：
+// - 新增后再更新仍是新增（内容取最新的），新增后又删除则两者都丢弃
+// - 更新后删除是删除，删除后再加入是更新（持久化层的 update 是按 id 覆盖写入）
+// - 清空会丢弃之前的全部变化，之后的变化照常累积，应用时先清空
+// 不同记录之间的变化互不影响，changes() 中的顺序没有意义
+class HistoryChangeBatch
+{
+public:
+    struct Change
+    {
+        HistoryChangeType type;
+        HistoryItem item;       // 删除时至少带有 id
+    };
+
+    bool isEmpty() const { return !m_cleared && m_changes.isEmpty(); }
+    bool isCleared() const { return m_cleared; }
+    const QList<Change> &changes() const { return m_changes; }
+
+    void record(HistoryChangeType type, const HistoryItem &item);
+
+private:
+    void drop(int index);
+
+    QList<Change> m_changes;
+    QHash<QString, int> m_indexById;
+    bool m_cleared = false;
+};
+
+} // namespace WinBrowserQt
+
+#endif // HISTORYCHANGES_H
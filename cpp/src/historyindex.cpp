@@ -0,0 +1,157 @@
+#include "historyindex.h"
+#include <QVarLengthArray>
+#include <algorithm>
+
+namespace WinBrowserQt {
+
+HistoryIndex::HistoryIndex()
+    : m_removed(0)
+{
+}
+
+void HistoryIndex::clear()
+{
+    m_documents.clear();
+    m_documentById.clear();
+    m_postings.clear();
+    m_removed = 0;
+}
+
+void HistoryIndex::build(const QList<HistoryItem> &items)
+{
+    clear();
+    m_documents.reserve(items.size());
+    m_documentById.reserve(items.size());
+    for (const auto &item : items) {
+        addDocument(item);
+    }
+}
+
+void HistoryIndex::update(const HistoryItem &item)
+{
+    auto it = m_documentById.constFind(item.id());
+    if (it != m_documentById.constEnd()) {
+        const Document &existing = m_documents[it.value()];
+        if (existing.url == item.url() && existing.title == item.title()) {
+            return;
+        }
+        remove(item.id());
+    }
+    addDocument(item);
+}
+
+void HistoryIndex::remove(const QString &historyId)
+{
+    auto it = m_documentById.find(historyId);
+    if (it == m_documentById.end()) {
+        return;
+    }
+
+    // 倒排表中的旧编号留到重建时清理，查询时按 alive 跳过
+    Document &document = m_documents[it.value()];
+    document.alive = false;
+    document.url.clear();
+    document.title.clear();
+    m_documentById.erase(it);
+    m_removed++;
+
+    if (m_removed >= MIN_COMPACT_REMOVED && m_removed > m_documentById.size()) {
+        compact();
+    }
+}
+
+bool HistoryIndex::forEachCandidate(const QString &query, qsizetype maxCandidates,
+                                    const std::function<void(const QString &historyId)> &visitor) const
+{
+    if (query.size() < 3) {
+        return false;
+    }
+
+    // 任一 trigram 没有倒排表时一定没有匹配
+    QVarLengthArray<const QList<DocId> *, 32> lists;
+    for (qsizetype i = 0; i + 2 < query.size(); ++i) {
+        auto it = m_postings.constFind(trigramKey(query[i], query[i + 1], query[i + 2]));
+        if (it == m_postings.constEnd()) {
+            return true;
+        }
+        lists.append(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const QList<DocId> *a, const QList<DocId> *b) {
+        return a->size() < b->size();
+    });
+    if (lists[0]->size() > maxCandidates) {
+        return false;
+    }
+
+    // 从最短的倒排表倒序遍历（最近加入的在前），在其余倒排表中二分查找
+    const QList<DocId> &smallest = *lists[0];
+    for (qsizetype i = smallest.size() - 1; i >= 0; --i) {
+        const DocId doc = smallest[i];
+        bool inAll = m_documents[doc].alive;
+        for (qsizetype k = 1; k < lists.size() && inAll; ++k) {
+            inAll = std::binary_search(lists[k]->cbegin(), lists[k]->cend(), doc);
+        }
+        if (inAll) {
+            visitor(m_documents[doc].historyId);
+        }
+    }
+    return true;
+}
+
+void HistoryIndex::addDocument(const HistoryItem &item)
+{
+    if (item.id().isEmpty()) {
+        return;
+    }
+
+    const DocId doc = DocId(m_documents.size());
+    Document document;
+    document.historyId = item.id();
+    document.url = item.url();
+    document.title = item.title();
+    m_documents.append(document);
+    m_documentById.insert(item.id(), doc);
+
+    indexText(item.url(), doc);
+    indexText(item.title(), doc);
+}
+
+void HistoryIndex::indexText(const QString &text, DocId doc)
+{
+    if (text.size() < 3) {
+        return;
+    }
+
+    // 编号递增加入，倒排表末尾是当前记录说明这个 trigram 已经加过
+    for (qsizetype i = 0; i + 2 < text.size(); ++i) {
+        QList<DocId> &list = m_postings[trigramKey(text[i], text[i + 1], text[i + 2])];
+        if (list.isEmpty() || list.last() != doc) {
+            list.append(doc);
+        }
+    }
+}
+
+void HistoryIndex::compact()
+{
+    QList<HistoryItem> items;
+    items.reserve(m_documentById.size());
+    for (const auto &document : std::as_const(m_documents)) {
+        if (document.alive) {
+            HistoryItem item;
+            item.setId(document.historyId);
+            item.setUrl(document.url);
+            item.setTitle(document.title);
+            items.append(item);
+        }
+    }
+    build(items);
+}
+
+quint64 HistoryIndex::trigramKey(QChar a, QChar b, QChar c)
+{
+    return (quint64(a.toCaseFolded().unicode()) << 32)
+        | (quint64(b.toCaseFolded().unicode()) << 16)
+        | quint64(c.toCaseFolded().unicode());
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,64 @@
+#ifndef HISTORYINDEX_H
+#define HISTORYINDEX_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <functional>
+#include "models/historyitem.h"
+
+namespace WinBrowserQt {
+
+// 历史记录的 trigram 倒排索引，为不区分大小写的子串搜索筛选候选
+// - URL 和标题按大小写折叠（与 TextMatcher 相同）后的连续三个字符建立倒排表，记录按加入顺序编号，倒排表天然有序
+// - 查询时取查询串所有 trigram 的倒排表，从最短的一个开始二分查找求交集；trigram 全部命中不代表连续出现，
+//   候选由调用方用原文核对
+// - 记录更新（标题变化）时旧编号标记为删除、以新编号重新加入；删除的编号多于有效编号时整体重建
+// 少于三个字符的查询无法使用索引
+class HistoryIndex
+{
+public:
+    HistoryIndex();
+
+    void clear();
+    void build(const QList<HistoryItem> &items);
+    // 新增或更新一条记录；URL 和标题都没有变化时直接返回
+    void update(const HistoryItem &item);
+    void remove(const QString &historyId);
+
+    int size() const { return int(m_documentById.size()); }
+
+    // 把包含查询串全部 trigram 的记录 id 交给 visitor，最近加入或更新的在前。
+    // 查询串少于三个字符，或最短的倒排表超过 maxCandidates（索引筛选不掉多少记录）时不访问任何记录并返回 false，
+    // 由调用方扫描全部记录
+    bool forEachCandidate(const QString &query, qsizetype maxCandidates,
+                          const std::function<void(const QString &historyId)> &visitor) const;
+
+private:
+    using DocId = quint32;
+
+    struct Document
+    {
+        QString historyId;
+        QString url;        // 与历史记录共享字符串数据
+        QString title;
+        bool alive = true;
+    };
+
+    void addDocument(const HistoryItem &item);
+    void indexText(const QString &text, DocId doc);
+    void compact();
+    static quint64 trigramKey(QChar a, QChar b, QChar c);
+
+    QList<Document> m_documents;                // 下标即编号
+    QHash<QString, DocId> m_documentById;       // 只包含有效编号
+    QHash<quint64, QList<DocId>> m_postings;
+    int m_removed;
+
+    // 删除的编号少于这个数时不重建
+    static const int MIN_COMPACT_REMOVED = 1024;
+};
+
+} // namespace WinBrowserQt
+
+#endif // HISTORYINDEX_H
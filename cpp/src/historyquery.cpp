@@ -0,0 +1,160 @@
+#include "historyquery.h"
+#include <QByteArray>
+#include <QDataStream>
+#include <QHashFunctions>
+#include <limits>
+
+namespace WinBrowserQt {
+
+namespace {
+
+const quint8 CURSOR_VERSION = 2;
+
+qint64 fromKey(const QDateTime &from)
+{
+    return from.isValid() ? from.toMSecsSinceEpoch() : HistoryQuery::NO_TIMESTAMP;
+}
+
+qint64 toKey(const QDateTime &to)
+{
+    return to.isValid() ? to.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+}
+
+QString normalizedHost(const QString &host)
+{
+    QString normalized = host.trimmed().toLower();
+    while (normalized.startsWith('.')) {
+        normalized.remove(0, 1);
+    }
+    return normalized;
+}
+
+// 查询条件的摘要：固定种子，同一版本内稳定；每页条数不参与，翻页时可以调整
+quint32 queryDigest(const HistoryQuery &query)
+{
+    return quint32(qHashMulti(0, fromKey(query.from), toKey(query.to), normalizedHost(query.host),
+                              query.text, int(query.order)));
+}
+
+} // namespace
+
+qint64 HistoryQuery::timeKey(const HistoryItem &item)
+{
+    return item.timestamp().isValid() ? item.timestamp().toMSecsSinceEpoch() : NO_TIMESTAMP;
+}
+
+QString HistoryCursor::encode(const HistoryQuery &query) const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << CURSOR_VERSION << queryDigest(query) << timestamp << qint32(visitCount) << key;
+    return QString::fromLatin1(data.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+
+bool HistoryCursor::decode(const QString &token, const HistoryQuery &query, HistoryCursor *cursor)
+{
+    const auto decoded = QByteArray::fromBase64Encoding(
+        token.toLatin1(), QByteArray::Base64UrlEncoding | QByteArray::AbortOnBase64DecodingErrors);
+    if (!decoded) {
+        return false;
+    }
+
+    QDataStream stream(*decoded);
+    quint8 version = 0;
+    quint32 digest = 0;
+    qint32 visitCount = 0;
+    HistoryCursor result;
+    stream >> version >> digest >> result.timestamp >> visitCount >> result.key;
+    if (stream.status() != QDataStream::Ok || version != CURSOR_VERSION || digest != queryDigest(query)) {
+        return false;
+    }
+
+    result.visitCount = visitCount;
+    *cursor = result;
+    return true;
+}
+
+bool HistoryCursor::precedes(qint64 itemTime, int itemVisits, quint64 itemKey, HistoryQuery::Order order) const
+{
+    const bool olderThanCursor = itemTime < timestamp || (itemTime == timestamp && itemKey < key);
+
+    switch (order) {
+    case HistoryQuery::Order::NewestFirst:
+        return olderThanCursor;
+    case HistoryQuery::Order::OldestFirst:
+        return itemTime > timestamp || (itemTime == timestamp && itemKey > key);
+    case HistoryQuery::Order::MostVisited:
+        return itemVisits < visitCount || (itemVisits == visitCount && olderThanCursor);
+    }
+    return false;
+}
+
+HistoryFilter::HistoryFilter(const HistoryQuery &query)
+    : m_from(fromKey(query.from))
+    , m_to(toKey(query.to))
+    , m_host(normalizedHost(query.host))
+    , m_text(query.text)
+{
+}
+
+bool HistoryFilter::matches(const HistoryItem &item) const
+{
+    return matchesTime(HistoryQuery::timeKey(item)) && matchesText(item.url(), item.title());
+}
+
+bool HistoryFilter::matchesTime(qint64 msecs) const
+{
+    if (m_from == HistoryQuery::NO_TIMESTAMP && m_to == std::numeric_limits<qint64>::max()) {
+        return true;
+    }
+    // 限定时间范围时排除没有时间戳的记录
+    return msecs != HistoryQuery::NO_TIMESTAMP && msecs >= m_from && msecs <= m_to;
+}
+
+bool HistoryFilter::matchesText(const QString &url, const QString &title) const
+{
+    if (!m_host.isEmpty() && !matchesHost(url)) {
+        return false;
+    }
+    return m_text.isEmpty() || m_text.matches(url) || m_text.matches(title);
+}
+
+bool HistoryFilter::matchesHost(QStringView url) const
+{
+    // 直接在原文中定位主机部分：协议之后、路径之前，去掉用户信息和端口
+    const qsizetype schemeEnd = url.indexOf(u"://");
+    if (schemeEnd < 0) {
+        return false;
+    }
+    QStringView authority = url.mid(schemeEnd + 3);
+    for (qsizetype i = 0; i < authority.size(); ++i) {
+        const QChar c = authority[i];
+        if (c == '/' || c == '?' || c == '#') {
+            authority.truncate(i);
+            break;
+        }
+    }
+    const qsizetype at = authority.lastIndexOf('@');
+    if (at >= 0) {
+        authority = authority.mid(at + 1);
+    }
+
+    QStringView host = authority;
+    if (host.startsWith('[')) {
+        const qsizetype close = host.indexOf(']');
+        host = close >= 0 ? host.mid(1, close - 1) : host.mid(1);
+    } else {
+        const qsizetype colon = host.indexOf(':');
+        if (colon >= 0) {
+            host.truncate(colon);
+        }
+    }
+
+    if (!host.endsWith(m_host, Qt::CaseInsensitive)) {
+        return false;
+    }
+    // 相等，或者是子域名（前一个字符为点）
+    return host.size() == m_host.size() || host[host.size() - m_host.size() - 1] == '.';
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,90 @@
+#ifndef HISTORYQUERY_H
+#define HISTORYQUERY_H
+
+#include <QString>
+#include <QStringView>
+#include <QList>
+#include <QDateTime>
+#include <limits>
+#include "textmatcher.h"
+#include "models/historyitem.h"
+
+namespace WinBrowserQt {
+
+// 历史记录查询条件：时间范围、主机和文本过滤，排序方式和每页条数
+class HistoryQuery
+{
+public:
+    enum class Order {
+        NewestFirst,
+        OldestFirst,
+        MostVisited     // 访问次数相同时最近访问的在前
+    };
+
+    QDateTime from;     // 无效时不限
+    QDateTime to;
+    QString host;       // 匹配这个主机及其子域名，为空时不限
+    QString text;       // URL 或标题包含的文本（不区分大小写），为空时不限
+    Order order = Order::NewestFirst;
+    int pageSize = DEFAULT_PAGE_SIZE;
+
+    static const int DEFAULT_PAGE_SIZE = 100;
+    static const int MAX_PAGE_SIZE = 1000;
+    static constexpr qint64 NO_TIMESTAMP = std::numeric_limits<qint64>::min();
+
+    // 记录的排序时间（epoch 毫秒）；没有时间戳的记录为 NO_TIMESTAMP，排在最旧的位置
+    static qint64 timeKey(const HistoryItem &item);
+};
+
+class HistoryPage
+{
+public:
+    QList<HistoryItem> items;
+    QString nextCursor;     // 为空表示没有更多结果
+};
+
+// 分页游标：上一页最后一条记录的排序键（时间、访问次数和历史记录表的 64 位键，键集分页），
+// 不保存任何服务端状态；键只在进程内有效
+// 编码时带上查询条件的摘要，用于另一组条件的游标会被拒绝
+// 翻页期间记录被再次访问时会移到新的位置，可能在后面的页中再次出现或被跳过
+class HistoryCursor
+{
+public:
+    qint64 timestamp = 0;
+    int visitCount = 0;
+    quint64 key = 0;
+
+    QString encode(const HistoryQuery &query) const;
+    static bool decode(const QString &token, const HistoryQuery &query, HistoryCursor *cursor);
+
+    // 按查询的排序方式，排序键为（timestamp, visitCount, key）的记录是否排在游标位置之后
+    bool precedes(qint64 timestamp, int visitCount, quint64 key, HistoryQuery::Order order) const;
+};
+
+// 查询条件预处理后的过滤器，匹配时不分配内存
+class HistoryFilter
+{
+public:
+    explicit HistoryFilter(const HistoryQuery &query);
+
+    qint64 fromMSecs() const { return m_from; }
+    qint64 toMSecs() const { return m_to; }
+    bool matches(const HistoryItem &item) const;
+
+    // 分列匹配：只有 hasTextFilter() 时才需要读取 URL 和标题
+    bool matchesTime(qint64 msecs) const;
+    bool hasTextFilter() const { return !m_host.isEmpty() || !m_text.isEmpty(); }
+    bool matchesText(const QString &url, const QString &title) const;
+
+private:
+    bool matchesHost(QStringView url) const;
+
+    qint64 m_from;
+    qint64 m_to;
+    QString m_host;
+    TextMatcher m_text;
+};
+
+} // namespace WinBrowserQt
+
+#endif // HISTORYQUERY_H
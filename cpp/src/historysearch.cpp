@@ -0,0 +1,144 @@
+#include "historysearch.h"
+#include "textmatcher.h"
+#include <QtConcurrent>
+#include <QThread>
+#include <algorithm>
+
+namespace WinBrowserQt {
+
+ParallelHistorySearch::ParallelHistorySearch(QObject *parent)
+    : QObject(parent)
+    , m_requestId(0)
+{
+    connect(&m_watcher, &QFutureWatcher<QList<HistoryItem>>::finished,
+            this, &ParallelHistorySearch::onWatcherFinished);
+}
+
+ParallelHistorySearch::~ParallelHistorySearch()
+{
+    // 线程池中的任务引用着回退来源，退出前等它们结束
+    cancel();
+    m_scan.waitForFinished();
+    m_watcher.waitForFinished();
+}
+
+void ParallelHistorySearch::start(quint64 requestId, const Snapshot &snapshot, const QString &query,
+                                  int limit, const Fallback &fallback)
+{
+    run(requestId, snapshot, nullptr, query, limit, fallback);
+}
+
+void ParallelHistorySearch::startWithCandidates(quint64 requestId, const Snapshot &snapshot,
+                                                const QList<int> &candidates, const QString &query,
+                                                int limit, const Fallback &fallback)
+{
+    run(requestId, snapshot, &candidates, query, limit, fallback);
+}
+
+void ParallelHistorySearch::run(quint64 requestId, const Snapshot &snapshot, const QList<int> *candidates,
+                                const QString &query, int limit, const Fallback &fallback)
+{
+    cancel();
+
+    m_requestId = requestId;
+    m_query = query;
+    m_cancelled = QSharedPointer<QAtomicInt>::create(0);
+    limit = qMax(0, limit);
+
+    // 分区数不超过线程数的两倍，留出余量让先完成的线程接手排队的分区
+    const qsizetype count = candidates ? candidates->size() : snapshot.size();
+    const qsizetype partitionCount = qBound<qsizetype>(1, count / MIN_PARTITION_SIZE,
+                                                       qMax(1, QThread::idealThreadCount() * 2));
+    const qsizetype partitionSize = (count + partitionCount - 1) / qMax<qsizetype>(1, partitionCount);
+    QList<Partition> partitions;
+    partitions.reserve(partitionCount);
+    for (qsizetype begin = 0; begin < count || partitions.isEmpty(); begin += partitionSize) {
+        partitions.append({snapshot, candidates ? *candidates : QList<int>(), candidates != nullptr,
+                           begin, qMin(count, begin + partitionSize)});
+        if (partitionSize == 0) {
+            break;
+        }
+    }
+
+    const QSharedPointer<QAtomicInt> cancelled = m_cancelled;
+    auto scan = [query, limit, cancelled](const Partition &partition) {
+        QList<Candidate> best;
+        const TextMatcher matcher(query);
+        for (qsizetype i = partition.begin; i < partition.end; ++i) {
+            if ((i - partition.begin) % CANCEL_CHECK_INTERVAL == 0 && cancelled->loadRelaxed()) {
+                return QList<Candidate>();
+            }
+            const qsizetype position = partition.indexed ? partition.candidates[i] : i;
+            const Entry &entry = partition.snapshot.at(int(position));
+            if (entry.item.id().isEmpty()
+                || (!matcher.matches(entry.item.url()) && !matcher.matches(entry.item.title()))) {
+                continue;
+            }
+            // 攒满两倍再截取，均摊后每个候选 O(1)
+            best.append({entry.rank, position});
+            if (best.size() >= 2 * qsizetype(qMax(1, limit))) {
+                keepBest(best, limit);
+            }
+        }
+        keepBest(best, limit);
+        return best;
+    };
+    auto merge = [limit](QList<Candidate> &result, const QList<Candidate> &partial) {
+        result.append(partial);
+        keepBest(result, limit);
+    };
+
+    m_scan = QtConcurrent::mappedReduced<QList<Candidate>>(std::move(partitions), scan, merge,
+                                                            QtConcurrent::UnorderedReduce);
+
+    // 排序和补充冷归档也在线程池中完成，界面线程只接收最终结果
+    QFuture<QList<HistoryItem>> results = m_scan.then(QtFuture::Launch::Async,
+        [snapshot, query, limit, fallback, cancelled](QList<Candidate> candidates) {
+            std::sort(candidates.begin(), candidates.end(), isBetter);
+
+            QList<HistoryItem> items;
+            items.reserve(candidates.size());
+            for (const auto &candidate : std::as_const(candidates)) {
+                items.append(snapshot.at(int(candidate.index)).item);
+            }
+            if (fallback && items.size() < limit && !cancelled->loadRelaxed()) {
+                items.append(fallback(query, limit - int(items.size())));
+            }
+            return items;
+        });
+    m_watcher.setFuture(results);
+}
+
+void ParallelHistorySearch::cancel()
+{
+    if (m_cancelled) {
+        m_cancelled->storeRelaxed(1);
+    }
+    m_scan.cancel();
+    m_watcher.cancel();
+}
+
+bool ParallelHistorySearch::isBetter(const Candidate &a, const Candidate &b)
+{
+    return a.rank > b.rank || (a.rank == b.rank && a.index > b.index);
+}
+
+void ParallelHistorySearch::keepBest(QList<Candidate> &candidates, int limit)
+{
+    if (candidates.size() <= limit) {
+        return;
+    }
+    std::nth_element(candidates.begin(), candidates.begin() + limit, candidates.end(), isBetter);
+    candidates.resize(limit);
+}
+
+void ParallelHistorySearch::onWatcherFinished()
+{
+    // 被取消的请求没有结果；被新请求替换的 future 不会再触发这里
+    if (m_watcher.isCanceled() || m_watcher.future().resultCount() == 0) {
+        return;
+    }
+    emit finished(m_requestId, m_query, m_watcher.result());
+}
+
+} // namespace WinBrowserQt
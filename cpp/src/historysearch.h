@@ -0,0 +1,90 @@
+#ifndef HISTORYSEARCH_H
+#define HISTORYSEARCH_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <functional>
+#include "models/historyitem.h"
+#include "models/persistentlist.h"
+
+namespace WinBrowserQt {
+
+// 历史记录的并行搜索，不占用界面线程
+// - 搜索对象是内存中记录的结构共享快照（PersistentList，带 frecency 排序键），取快照为 O(1)；
+//   调用方在历史变化时逐条更新列表，不需要在界面线程上整体复制。id 为空的条目是已删除记录留下的空位
+// - 快照切分为若干分区，QtConcurrent::mappedReduced 在全局线程池中并行扫描，每个分区只保留自己的前 k 条，
+//   归并时再截取全局前 k 条；调用方已用索引筛出候选位置时只核对和排序这些位置
+// - 新的搜索会取消尚未完成的上一次搜索：已排队的分区不再执行，正在扫描的分区定期检查取消标记
+// - 结果由界面线程中的 QFutureWatcher 转为 finished 信号发出，过期请求的结果不会发出
+class ParallelHistorySearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry
+    {
+        HistoryItem item;
+        double rank = 0;
+    };
+    using Snapshot = PersistentList<Entry>::Snapshot;
+    // 内存结果不足时补充的来源（冷归档），在线程池中调用，必须是线程安全的
+    using Fallback = std::function<QList<HistoryItem>(const QString &query, int limit)>;
+
+    explicit ParallelHistorySearch(QObject *parent = nullptr);
+    ~ParallelHistorySearch();
+
+    // requestId 原样带回 finished 信号，用于区分请求
+    void start(quint64 requestId, const Snapshot &snapshot, const QString &query, int limit,
+               const Fallback &fallback = Fallback());
+    // 只核对 candidates 中的位置（快照下标，可以无序），其余与 start 相同
+    void startWithCandidates(quint64 requestId, const Snapshot &snapshot, const QList<int> &candidates,
+                             const QString &query, int limit, const Fallback &fallback = Fallback());
+    void cancel();
+    bool isRunning() const { return m_watcher.isRunning(); }
+
+signals:
+    void finished(quint64 requestId, const QString &query, const QList<HistoryItem> &results);
+
+private:
+    struct Candidate
+    {
+        double rank;
+        qsizetype index;    // 快照中的位置，排序键相同时位置靠后的在前
+    };
+
+    // 没有候选列表时 [begin, end) 是快照下标，否则是候选列表的下标
+    struct Partition
+    {
+        Snapshot snapshot;
+        QList<int> candidates;
+        bool indexed;
+        qsizetype begin;
+        qsizetype end;
+    };
+
+    void run(quint64 requestId, const Snapshot &snapshot, const QList<int> *candidates,
+             const QString &query, int limit, const Fallback &fallback);
+    static bool isBetter(const Candidate &a, const Candidate &b);
+    static void keepBest(QList<Candidate> &candidates, int limit);
+    void onWatcherFinished();
+
+    QFuture<QList<Candidate>> m_scan;
+    QFutureWatcher<QList<HistoryItem>> m_watcher;
+    QSharedPointer<QAtomicInt> m_cancelled;
+    quint64 m_requestId;
+    QString m_query;
+
+    // 每个分区至少这么多条记录，记录较少时不值得切分
+    static const int MIN_PARTITION_SIZE = 4096;
+    // 扫描时每隔这么多条检查一次取消标记
+    static const int CANCEL_CHECK_INTERVAL = 1024;
+};
+
+} // namespace WinBrowserQt
+
+#endif // HISTORYSEARCH_H
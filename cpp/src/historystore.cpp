@@ -0,0 +1,460 @@
+#include "historystore.h"
+#include <QUrl>
+#include <QUuid>
+#include <QSet>
+#include <algorithm>
+#include <limits>
+
+namespace WinBrowserQt {
+
+HistoryStore::HistoryStore()
+    : m_nextKey(1)
+    , m_visitHead(0)
+{
+}
+
+HistoryStore::~HistoryStore()
+{
+    clear();
+}
+
+void HistoryStore::load(const QList<HistoryItem> &items, QStringList *mergedIds,
+                        QStringList *updatedIds)
+{
+    clear();
+    m_keys.reserve(items.size());
+    m_ids.reserve(items.size());
+    m_timestamps.reserve(items.size());
+    m_visitCounts.reserve(items.size());
+    m_urls.reserve(items.size());
+    m_titles.reserve(items.size());
+    m_normalizedUrls.reserve(items.size());
+    m_slotById.reserve(items.size());
+
+    QSet<int> updatedSlots;
+    for (const auto &item : items) {
+        if (item.id().isEmpty() || m_slotById.contains(item.id())) {
+            continue;
+        }
+
+        const QString normalizedUrl = normalizeUrl(item.url());
+        const int slot = slotForUrl(normalizedUrl);
+        if (slot < 0) {
+            insertSlot(item, normalizedUrl);
+            continue;
+        }
+
+        // 旧版本每次访问都会产生一条记录，载入时合并到同一个 URL 下
+        m_visitCounts[slot] += qMax(1, item.visitCount());
+        const qint64 timestamp = HistoryQuery::timeKey(item);
+        if (timestamp > m_timestamps[slot]) {
+            setTimestamp(slot, timestamp);
+            setTitle(slot, item.title());
+        }
+        if (mergedIds) {
+            mergedIds->append(item.id());
+        }
+        updatedSlots.insert(slot);
+    }
+
+    if (updatedIds) {
+        for (int slot : std::as_const(updatedSlots)) {
+            updatedIds->append(m_ids[slot]);
+        }
+    }
+}
+
+HistoryItem HistoryStore::recordVisit(const QString &url, const QString &title,
+                                      const QDateTime &when, bool *created)
+{
+    const QString normalizedUrl = normalizeUrl(url);
+    int slot = slotForUrl(normalizedUrl);
+    if (created) {
+        *created = slot < 0;
+    }
+
+    const qint64 timestamp = when.toMSecsSinceEpoch();
+    if (slot >= 0) {
+        m_visitCounts[slot]++;
+        setTimestamp(slot, timestamp);
+        if (!title.isEmpty()) {
+            setTitle(slot, title);
+        }
+    } else {
+        HistoryItem item;
+        item.setId(QUuid::createUuid().toString());
+        item.setUrl(url);
+        item.setTitle(title.isEmpty() ? url : title);
+        item.setTimestamp(when);
+        item.setVisitCount(1);
+        slot = insertSlot(item, normalizedUrl);
+    }
+
+    appendVisit(slot, timestamp);
+    return itemAt(slot);
+}
+
+HistoryItem HistoryStore::merge(const HistoryItem &item, bool *created)
+{
+    const QString normalizedUrl = normalizeUrl(item.url());
+    int slot = slotForUrl(normalizedUrl);
+    if (created) {
+        *created = slot < 0;
+    }
+
+    if (slot >= 0) {
+        m_visitCounts[slot] += qMax(1, item.visitCount());
+        const qint64 timestamp = HistoryQuery::timeKey(item);
+        if (timestamp > m_timestamps[slot]) {
+            setTimestamp(slot, timestamp);
+            if (!item.title().isEmpty()) {
+                setTitle(slot, item.title());
+            }
+        }
+    } else {
+        HistoryItem inserted = item;
+        if (inserted.id().isEmpty() || m_slotById.contains(inserted.id())) {
+            inserted.setId(QUuid::createUuid().toString());
+        }
+        inserted.setVisitCount(qMax(1, item.visitCount()));
+        slot = insertSlot(inserted, normalizedUrl);
+    }
+    return itemAt(slot);
+}
+
+HistoryItem HistoryStore::item(const QString &id) const
+{
+    auto it = m_slotById.constFind(id);
+    return it != m_slotById.constEnd() ? itemAt(it.value()) : HistoryItem();
+}
+
+HistoryItem HistoryStore::itemForUrl(const QString &url) const
+{
+    const int slot = slotForUrl(normalizeUrl(url));
+    return slot >= 0 ? itemAt(slot) : HistoryItem();
+}
+
+QString HistoryStore::idForUrl(const QString &url) const
+{
+    const int slot = slotForUrl(normalizeUrl(url));
+    return slot >= 0 ? m_ids[slot] : QString();
+}
+
+bool HistoryStore::remove(const QString &id, HistoryItem *removed)
+{
+    auto it = m_slotById.find(id);
+    if (it == m_slotById.end()) {
+        return false;
+    }
+
+    const int slot = it.value();
+    if (removed) {
+        *removed = itemAt(slot);
+    }
+
+    m_slotById.erase(it);
+    m_slotByUrl.remove(m_normalizedUrls[slot]);
+    m_slotByKey.remove(m_keys[slot]);
+    m_slotByTime.remove(timeKeyAt(slot));
+
+    m_keys[slot] = 0;
+    m_ids[slot].clear();
+    releaseSlotStrings(slot);
+    m_freeSlots.append(slot);
+    return true;
+}
+
+void HistoryStore::clear()
+{
+    for (int slot : std::as_const(m_slotById)) {
+        releaseSlotStrings(slot);
+    }
+    m_keys.clear();
+    m_ids.clear();
+    m_timestamps.clear();
+    m_visitCounts.clear();
+    m_urls.clear();
+    m_titles.clear();
+    m_normalizedUrls.clear();
+    m_freeSlots.clear();
+    m_slotById.clear();
+    m_slotByUrl.clear();
+    m_slotByKey.clear();
+    m_slotByTime.clear();
+    m_visits.clear();
+    m_visitHead = 0;
+}
+
+QList<HistoryItem> HistoryStore::items() const
+{
+    QList<HistoryItem> result;
+    result.reserve(m_slotByTime.size());
+    for (int slot : m_slotByTime) {
+        result.append(itemAt(slot));
+    }
+    return result;
+}
+
+HistoryPage HistoryStore::query(const HistoryQuery &query, const HistoryCursor *cursor) const
+{
+    if (query.order == HistoryQuery::Order::MostVisited) {
+        return queryByVisits(query, cursor);
+    }
+    return queryByTime(query, cursor);
+}
+
+HistoryPage HistoryStore::queryByTime(const HistoryQuery &query, const HistoryCursor *cursor) const
+{
+    const HistoryFilter filter(query);
+    const int pageSize = qBound(1, query.pageSize, HistoryQuery::MAX_PAGE_SIZE);
+    const bool newestFirst = query.order == HistoryQuery::Order::NewestFirst;
+
+    // 多取一条判断是否还有下一页
+    QList<int> slots;
+    slots.reserve(pageSize + 1);
+    auto collect = [&](int slot) {
+        if (matchesAt(filter, slot)) {
+            slots.append(slot);
+        }
+        return slots.size() <= pageSize;
+    };
+
+    if (newestFirst) {
+        // 起点取游标和时间上界中较早的一个，向旧的方向遍历
+        auto it = m_slotByTime.cend();
+        if (filter.toMSecs() != std::numeric_limits<qint64>::max()) {
+            it = m_slotByTime.lowerBound(TimeKey{filter.toMSecs() + 1, 0});
+        }
+        if (cursor) {
+            const auto cursorIt = m_slotByTime.lowerBound(TimeKey{cursor->timestamp, cursor->key});
+            if (it == m_slotByTime.cend() || (cursorIt != m_slotByTime.cend() && cursorIt.key() < it.key())) {
+                it = cursorIt;
+            }
+        }
+        while (it != m_slotByTime.cbegin()) {
+            --it;
+            if (it.key().msecs < filter.fromMSecs() || !collect(it.value())) {
+                break;
+            }
+        }
+    } else {
+        auto it = m_slotByTime.lowerBound(TimeKey{filter.fromMSecs(), 0});
+        if (cursor) {
+            const auto cursorIt = m_slotByTime.upperBound(TimeKey{cursor->timestamp, cursor->key});
+            if (cursorIt == m_slotByTime.cend() || (it != m_slotByTime.cend() && it.key() < cursorIt.key())) {
+                it = cursorIt;
+            }
+        }
+        for (; it != m_slotByTime.cend(); ++it) {
+            if (it.key().msecs > filter.toMSecs() || !collect(it.value())) {
+                break;
+            }
+        }
+    }
+
+    return pageFromSlots(query, slots, pageSize);
+}
+
+HistoryPage HistoryStore::queryByVisits(const HistoryQuery &query, const HistoryCursor *cursor) const
+{
+    const HistoryFilter filter(query);
+    const int pageSize = qBound(1, query.pageSize, HistoryQuery::MAX_PAGE_SIZE);
+    const int keep = pageSize + 1;
+
+    // 排在前面的记录优先：访问次数多、时间新、键大；堆顶是当前保留的最差一条。
+    // 比较只读访问次数、时间和键三列
+    auto isBetter = [this](int a, int b) {
+        if (m_visitCounts[a] != m_visitCounts[b]) {
+            return m_visitCounts[a] > m_visitCounts[b];
+        }
+        return timeKeyAt(b) < timeKeyAt(a);
+    };
+
+    QList<int> heap;
+    heap.reserve(keep);
+    for (int slot : m_slotById) {
+        if (cursor && !cursor->precedes(m_timestamps[slot], m_visitCounts[slot], m_keys[slot], query.order)) {
+            continue;
+        }
+        // 先和堆顶比较，进不了前 k 的记录不读取文本列
+        if (heap.size() >= keep && !isBetter(slot, heap.first())) {
+            continue;
+        }
+        if (!matchesAt(filter, slot)) {
+            continue;
+        }
+        if (heap.size() < keep) {
+            heap.append(slot);
+            std::push_heap(heap.begin(), heap.end(), isBetter);
+        } else {
+            std::pop_heap(heap.begin(), heap.end(), isBetter);
+            heap.last() = slot;
+            std::push_heap(heap.begin(), heap.end(), isBetter);
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), isBetter);
+
+    return pageFromSlots(query, heap, pageSize);
+}
+
+HistoryPage HistoryStore::pageFromSlots(const HistoryQuery &query, QList<int> slots, int pageSize) const
+{
+    HistoryPage page;
+    const bool hasMore = slots.size() > pageSize;
+    if (hasMore) {
+        slots.resize(pageSize);
+    }
+
+    page.items.reserve(slots.size());
+    for (int slot : std::as_const(slots)) {
+        page.items.append(itemAt(slot));
+    }
+    if (hasMore) {
+        const int last = slots.last();
+        HistoryCursor cursor;
+        cursor.timestamp = m_timestamps[last];
+        cursor.visitCount = m_visitCounts[last];
+        cursor.key = m_keys[last];
+        page.nextCursor = cursor.encode(query);
+    }
+    return page;
+}
+
+QList<HistoryStore::Visit> HistoryStore::recentVisits(int limit) const
+{
+    QList<Visit> result;
+    const int count = int(m_visits.size());
+    for (int i = 0; i < count && result.size() < limit; ++i) {
+        // 环形缓冲区中最新的访问位于 head 之前
+        const VisitRecord &record = m_visits[(m_visitHead - 1 - i + count) % count];
+        const int slot = m_slotByKey.value(record.key, -1);
+        if (slot >= 0) {
+            Visit visit;
+            visit.id = m_ids[slot];
+            visit.timestamp = record.timestamp;
+            result.append(visit);
+        }
+    }
+    return result;
+}
+
+QString HistoryStore::normalizeUrl(const QString &url)
+{
+    const QUrl parsed(url);
+    if (!parsed.isValid()) {
+        return url;
+    }
+    // QUrl 解析时已经把协议和主机转为小写
+    return parsed.adjusted(QUrl::RemoveFragment | QUrl::StripTrailingSlash | QUrl::NormalizePathSegments)
+        .toString(QUrl::FullyEncoded);
+}
+
+HistoryItem HistoryStore::itemAt(int slot) const
+{
+    // 字符串从池中取出，与池中实例共享数据
+    const StringPool &pool = StringPool::instance();
+    HistoryItem item;
+    item.setId(m_ids[slot]);
+    item.setUrl(pool.string(m_urls[slot]));
+    item.setTitle(pool.string(m_titles[slot]));
+    if (m_timestamps[slot] != HistoryQuery::NO_TIMESTAMP) {
+        item.setTimestamp(QDateTime::fromMSecsSinceEpoch(m_timestamps[slot]));
+    }
+    item.setVisitCount(m_visitCounts[slot]);
+    return item;
+}
+
+bool HistoryStore::matchesAt(const HistoryFilter &filter, int slot) const
+{
+    if (!filter.matchesTime(m_timestamps[slot])) {
+        return false;
+    }
+    if (!filter.hasTextFilter()) {
+        return true;
+    }
+    const StringPool &pool = StringPool::instance();
+    return filter.matchesText(pool.string(m_urls[slot]), pool.string(m_titles[slot]));
+}
+
+void HistoryStore::setTimestamp(int slot, qint64 msecs)
+{
+    m_slotByTime.remove(timeKeyAt(slot));
+    m_timestamps[slot] = msecs;
+    m_slotByTime.insert(timeKeyAt(slot), slot);
+}
+
+int HistoryStore::slotForUrl(const QString &normalizedUrl) const
+{
+    // 只查找不驻留，查询用的 URL 不会留在池中
+    const StringPool::Handle handle = StringPool::instance().find(normalizedUrl);
+    return handle != StringPool::NullHandle ? m_slotByUrl.value(handle, -1) : -1;
+}
+
+int HistoryStore::insertSlot(const HistoryItem &item, const QString &normalizedUrl)
+{
+    int slot;
+    if (!m_freeSlots.isEmpty()) {
+        slot = m_freeSlots.takeLast();
+    } else {
+        slot = int(m_keys.size());
+        m_keys.append(0);
+        m_ids.append(QString());
+        m_timestamps.append(HistoryQuery::NO_TIMESTAMP);
+        m_visitCounts.append(0);
+        m_urls.append(StringPool::NullHandle);
+        m_titles.append(StringPool::NullHandle);
+        m_normalizedUrls.append(StringPool::NullHandle);
+    }
+
+    StringPool &pool = StringPool::instance();
+    m_keys[slot] = m_nextKey++;
+    m_ids[slot] = item.id();
+    m_timestamps[slot] = HistoryQuery::timeKey(item);
+    m_visitCounts[slot] = item.visitCount();
+    m_urls[slot] = pool.acquire(item.url());
+    m_titles[slot] = pool.acquire(item.title());
+    m_normalizedUrls[slot] = pool.acquire(normalizedUrl);
+
+    m_slotById.insert(item.id(), slot);
+    m_slotByUrl.insert(m_normalizedUrls[slot], slot);
+    m_slotByKey.insert(m_keys[slot], slot);
+    m_slotByTime.insert(timeKeyAt(slot), slot);
+    return slot;
+}
+
+void HistoryStore::setTitle(int slot, const QString &title)
+{
+    // 先取得新句柄再释放旧句柄，标题不变时字符串不会被释放后重建
+    StringPool &pool = StringPool::instance();
+    const StringPool::Handle previous = m_titles[slot];
+    m_titles[slot] = pool.acquire(title);
+    pool.release(previous);
+}
+
+void HistoryStore::releaseSlotStrings(int slot)
+{
+    StringPool &pool = StringPool::instance();
+    pool.release(m_urls[slot]);
+    pool.release(m_titles[slot]);
+    pool.release(m_normalizedUrls[slot]);
+    m_urls[slot] = StringPool::NullHandle;
+    m_titles[slot] = StringPool::NullHandle;
+    m_normalizedUrls[slot] = StringPool::NullHandle;
+}
+
+void HistoryStore::appendVisit(int slot, qint64 timestamp)
+{
+    VisitRecord visit;
+    visit.key = m_keys[slot];
+    visit.timestamp = timestamp;
+
+    if (m_visits.size() < MAX_VISIT_LOG) {
+        m_visits.append(visit);
+        m_visitHead = int(m_visits.size()) % MAX_VISIT_LOG;
+    } else {
+        m_visits[m_visitHead] = visit;
+        m_visitHead = (m_visitHead + 1) % MAX_VISIT_LOG;
+    }
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,133 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMap>
+#include <QDateTime>
+#include <QStringList>
+#include "historyquery.h"
+#include "models/historyitem.h"
+#include "models/stringpool.h"
+
+namespace WinBrowserQt {
+
+// 按 URL 聚合的历史记录表：每个规范化 URL 只有一条记录（访问次数、最后访问时间、标题），
+// 重复访问只更新这条记录，内存随不同 URL 的数量而不是访问次数增长
+// - 列式存储：键、时间（epoch 毫秒）、访问次数、URL/标题的字符串池句柄各自是连续数组，下标即槽位；
+//   时间范围扫描和排序只读取需要的列，HistoryItem 只在返回结果时按槽位组装
+// - 每条记录有一个进程内单调递增的 64 位键，内部索引和分页游标都用它，不再比较字符串 id；
+//   字符串 id 只为持久化格式保留一列
+// - 删除后槽位进入空闲列表复用；URL、标题列持有字符串池句柄的引用，删除、清空或标题变化时释放，
+//   清空的历史记录不会继续留在池中
+// - id → 槽位、规范化 URL 句柄 → 槽位、键 → 槽位三个哈希索引，查找、删除均为 O(1)
+// - 按（最后访问时间，键）排序的索引，时间范围查询和分页为 O(log n + 页大小)
+// - 访问日志单独保存（只记键和时间），容量固定，超出后覆盖最旧的访问
+class HistoryStore
+{
+public:
+    using Key = quint64;
+
+    struct Visit
+    {
+        QString id;         // 与记录共享字符串数据
+        qint64 timestamp = 0;
+    };
+
+    static const int MAX_VISIT_LOG = 10000;
+
+    HistoryStore();
+    ~HistoryStore();
+
+    // 载入已持久化的记录，规范化后相同的 URL 会合并：
+    // mergedIds 返回被合并掉的记录，updatedIds 返回合并后发生变化的记录，调用方据此更新持久化数据
+    void load(const QList<HistoryItem> &items, QStringList *mergedIds = nullptr,
+              QStringList *updatedIds = nullptr);
+
+    // 记录一次访问：URL 已存在时访问次数加一并更新标题和时间，否则创建新记录
+    HistoryItem recordVisit(const QString &url, const QString &title,
+                            const QDateTime &when, bool *created = nullptr);
+
+    // 合并一条外部记录（导入）：URL 已存在时累加访问次数，时间较新时更新标题和时间；
+    // 不算作一次访问，不写入访问日志
+    HistoryItem merge(const HistoryItem &item, bool *created = nullptr);
+
+    bool contains(const QString &id) const { return m_slotById.contains(id); }
+    HistoryItem item(const QString &id) const;
+    HistoryItem itemForUrl(const QString &url) const;
+    // 不组装整条记录，只返回 id；URL 不存在时为空
+    QString idForUrl(const QString &url) const;
+    bool remove(const QString &id, HistoryItem *removed = nullptr);
+    void clear();
+
+    int size() const { return int(m_slotById.size()); }
+    bool isEmpty() const { return m_slotById.isEmpty(); }
+
+    // 按最后访问时间升序返回全部记录
+    QList<HistoryItem> items() const;
+    // 分页查询：cursor 为空时从第一页开始；按时间排序时只遍历时间范围内的记录，
+    // 按访问次数排序时扫描访问次数和时间两列，只保留一页大小的堆
+    HistoryPage query(const HistoryQuery &query, const HistoryCursor *cursor = nullptr) const;
+    // 最近的访问，最新的在前，已删除记录的访问会被跳过
+    QList<Visit> recentVisits(int limit) const;
+
+    // 规范化 URL：协议和主机小写，去掉片段和末尾斜杠
+    static QString normalizeUrl(const QString &url);
+
+private:
+    struct TimeKey
+    {
+        qint64 msecs;
+        Key key;
+
+        bool operator<(const TimeKey &other) const
+        {
+            return msecs < other.msecs || (msecs == other.msecs && key < other.key);
+        }
+    };
+
+    struct VisitRecord
+    {
+        Key key;
+        qint64 timestamp;
+    };
+
+    HistoryItem itemAt(int slot) const;
+    TimeKey timeKeyAt(int slot) const { return {m_timestamps[slot], m_keys[slot]}; }
+    bool matchesAt(const HistoryFilter &filter, int slot) const;
+    HistoryPage pageFromSlots(const HistoryQuery &query, QList<int> slots, int pageSize) const;
+    void setTimestamp(int slot, qint64 msecs);
+    HistoryPage queryByTime(const HistoryQuery &query, const HistoryCursor *cursor) const;
+    HistoryPage queryByVisits(const HistoryQuery &query, const HistoryCursor *cursor) const;
+    int slotForUrl(const QString &normalizedUrl) const;
+    int insertSlot(const HistoryItem &item, const QString &normalizedUrl);
+    void setTitle(int slot, const QString &title);
+    void releaseSlotStrings(int slot);
+    void appendVisit(int slot, qint64 timestamp);
+
+    // 列，下标即槽位；已删除的槽位键为 0
+    QList<Key> m_keys;
+    QList<QString> m_ids;
+    QList<qint64> m_timestamps;                 // 没有时间戳时为 HistoryQuery::NO_TIMESTAMP
+    QList<qint32> m_visitCounts;
+    QList<StringPool::Handle> m_urls;
+    QList<StringPool::Handle> m_titles;
+    QList<StringPool::Handle> m_normalizedUrls;
+    QList<int> m_freeSlots;
+    Key m_nextKey;
+
+    QHash<QString, int> m_slotById;
+    QHash<StringPool::Handle, int> m_slotByUrl;
+    QHash<Key, int> m_slotByKey;
+    QMap<TimeKey, int> m_slotByTime;
+
+    QList<VisitRecord> m_visits;                // 环形缓冲区
+    int m_visitHead;
+
+    Q_DISABLE_COPY(HistoryStore)
+};
+
+} // namespace WinBrowserQt
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,178 @@
+#include "journalfile.h"
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace WinBrowserQt {
+
+JournalFile::JournalFile(const QString &path)
+    : m_path(path)
+    , m_recordCount(-1)
+{
+}
+
+JournalFile::~JournalFile()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+bool JournalFile::ensureOpen()
+{
+    if (m_file.isOpen()) {
+        return true;
+    }
+
+    // 首次打开时统计已有记录数，用于判断何时需要压缩；
+    // 崩溃留下的半行截断到最后一个换行，否则之后追加的记录会接在半行后面，重放时整行被当作损坏丢弃
+    if (m_recordCount < 0) {
+        m_recordCount = 0;
+        QFile existing(m_path);
+        if (existing.open(QIODevice::ReadWrite)) {
+            const QByteArray data = existing.readAll();
+            m_recordCount = data.count('\n');
+            if (!data.isEmpty() && !data.endsWith('\n')) {
+                const qsizetype complete = data.lastIndexOf('\n') + 1;
+                qWarning() << "截断日志末尾不完整的记录:" << m_path << (data.size() - complete) << "字节";
+                if (!existing.resize(complete)) {
+                    qWarning() << "截断日志文件失败:" << m_path << existing.errorString();
+                    existing.close();
+                    return false;
+                }
+            }
+            existing.close();
+        }
+    }
+
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "打开日志文件失败:" << m_path << m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool JournalFile::append(const QJsonObject &record)
+{
+    QByteArray line = QJsonDocument(record).toJson(QJsonDocument::Compact);
+    line.append('\n');
+
+    QMutexLocker locker(&m_mutex);
+    if (!ensureOpen()) {
+        return false;
+    }
+
+    // 整行一次写入并立即刷新，进程崩溃时最多丢失正在写的这一行
+    if (m_file.write(line) != line.size() || !m_file.flush()) {
+        qWarning() << "写入日志文件失败:" << m_path << m_file.errorString();
+        return false;
+    }
+    m_recordCount++;
+    return true;
+}
+
+bool JournalFile::append(const QList<QJsonObject> &records)
+{
+    if (records.isEmpty()) {
+        return true;
+    }
+
+    QByteArray lines;
+    for (const auto &record : records) {
+        lines.append(QJsonDocument(record).toJson(QJsonDocument::Compact));
+        lines.append('\n');
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (!ensureOpen()) {
+        return false;
+    }
+
+    // 崩溃时可能留下前面几条完整记录和一条半行，重放时半行会被跳过
+    if (m_file.write(lines) != lines.size() || !m_file.flush()) {
+        qWarning() << "写入日志文件失败:" << m_path << m_file.errorString();
+        return false;
+    }
+    m_recordCount += int(records.size());
+    return true;
+}
+
+int JournalFile::recordCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return qMax(0, m_recordCount);
+}
+
+bool JournalFile::rotate(const QString &archivePath)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+
+    if (!QFile::exists(m_path)) {
+        m_recordCount = 0;
+        return false;
+    }
+
+    if (!QFile::rename(m_path, archivePath)) {
+        qWarning() << "轮转日志文件失败:" << m_path << "->" << archivePath;
+        return false;
+    }
+    m_recordCount = 0;
+    return true;
+}
+
+void JournalFile::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    QFile::remove(m_path);
+    m_recordCount = 0;
+}
+
+QList<QJsonObject> JournalFile::replay(const QString &path)
+{
+    QList<QJsonObject> records;
+
+    QFile file(path);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return records;
+    }
+
+    const QByteArray data = file.readAll();
+    file.close();
+
+    qsizetype start = 0;
+    while (start < data.size()) {
+        const qsizetype end = data.indexOf('\n', start);
+        if (end < 0) {
+            // 没有换行结尾的最后一行是崩溃时写了一半的记录，直接丢弃
+            qWarning() << "忽略日志末尾不完整的记录:" << path;
+            break;
+        }
+
+        const QByteArray line = data.mid(start, end - start);
+        start = end + 1;
+        if (line.trimmed().isEmpty()) {
+            continue;
+        }
+
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+        if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+            qWarning() << "忽略损坏的日志记录:" << path << error.errorString();
+            continue;
+        }
+        records.append(doc.object());
+    }
+
+    return records;
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,44 @@
+#ifndef JOURNALFILE_H
+#define JOURNALFILE_H
+
+#include <QString>
+#include <QList>
+#include <QFile>
+#include <QMutex>
+#include <QJsonObject>
+
+namespace WinBrowserQt {
+
+// 只追加日志文件：每条记录是一行紧凑 JSON
+// 追加的开销与已有记录数量无关；重放时会跳过进程崩溃留下的半行记录
+class JournalFile
+{
+public:
+    explicit JournalFile(const QString &path);
+    ~JournalFile();
+
+    QString path() const { return m_path; }
+
+    bool append(const QJsonObject &record);
+    // 多条记录一次写入、一次刷新
+    bool append(const QList<QJsonObject> &records);
+    int recordCount() const;
+
+    // 将当前日志原子地改名为 archivePath，之后的追加写入新的空日志
+    bool rotate(const QString &archivePath);
+    void reset();
+
+    static QList<QJsonObject> replay(const QString &path);
+
+private:
+    bool ensureOpen();
+
+    QString m_path;
+    QFile m_file;
+    int m_recordCount;
+    mutable QMutex m_mutex;
+};
+
+} // namespace WinBrowserQt
+
+#endif // JOURNALFILE_H
@@ -0,0 +1,88 @@
+#include "latencyhistogram.h"
+#include <QtAlgorithms>
+#include <cmath>
+
+namespace WinBrowserQt {
+
+namespace {
+
+// SUB_BUCKETS = 2^SUB_BITS；小于 SUB_BUCKETS 的值每个值一个桶
+const int SUB_BITS = 3;
+// 最大可区分约 2^31 微秒（半个多小时），更大的值计入最后一个桶
+const int MAX_EXPONENT = 30;
+const int BUCKET_COUNT = LatencyHistogram::SUB_BUCKETS * (MAX_EXPONENT - SUB_BITS + 2);
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+    : m_buckets(BUCKET_COUNT, 0)
+    , m_count(0)
+    , m_max(0)
+{
+}
+
+void LatencyHistogram::record(qint64 microseconds)
+{
+    microseconds = qMax<qint64>(0, microseconds);
+    ++m_buckets[bucketFor(microseconds)];
+    ++m_count;
+    m_max = qMax(m_max, microseconds);
+}
+
+void LatencyHistogram::clear()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_max = 0;
+}
+
+qint64 LatencyHistogram::percentile(double percent) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    const qint64 target = qBound<qint64>(1, qint64(std::ceil(percent / 100.0 * double(m_count))), m_count);
+    qint64 seen = 0;
+    for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        seen += m_buckets[bucket];
+        if (seen >= target) {
+            return qMin(bucketUpperBound(bucket), m_max);
+        }
+    }
+    return m_max;
+}
+
+QString LatencyHistogram::summary() const
+{
+    auto ms = [](qint64 microseconds) { return QString::number(double(microseconds) / 1000.0, 'f', 1); };
+    return QString("n=%1 p50=%2ms p95=%3ms p99=%4ms max=%5ms")
+        .arg(m_count)
+        .arg(ms(percentile(50)), ms(percentile(95)), ms(percentile(99)), ms(m_max));
+}
+
+int LatencyHistogram::bucketFor(qint64 microseconds)
+{
+    if (microseconds < SUB_BUCKETS) {
+        return int(microseconds);
+    }
+    const int exponent = 63 - qCountLeadingZeroBits(quint64(microseconds));
+    if (exponent > MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+    // 最高位之后的 SUB_BITS 位决定区间内的桶
+    const int sub = int(microseconds >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS * (exponent - SUB_BITS + 1) + sub;
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int bucket)
+{
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    const int exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    const int sub = bucket % SUB_BUCKETS;
+    return (qint64(SUB_BUCKETS + sub + 1) << (exponent - SUB_BITS)) - 1;
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,41 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QString>
+#include <QList>
+
+namespace WinBrowserQt {
+
+// 延迟直方图（微秒），用于统计交互延迟的百分位
+// - 对数分桶：每个 2 的幂区间再等分为 SUB_BUCKETS 个桶，相对误差不超过 1/SUB_BUCKETS，
+//   桶的数量固定，记录为 O(1)，不保存原始样本
+// - 超出范围的值计入最后一个桶，最大值单独记录
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(qint64 microseconds);
+    void clear();
+
+    qint64 count() const { return m_count; }
+    qint64 maximum() const { return m_max; }
+    // 第 percent 百分位（0–100），返回所在桶的上界，不超过最大值；没有样本时为 0
+    qint64 percentile(double percent) const;
+    // 一行摘要：样本数、p50/p95/p99 和最大值（毫秒），用于日志和回归对比
+    QString summary() const;
+
+    static const int SUB_BUCKETS = 8;
+
+private:
+    static int bucketFor(qint64 microseconds);
+    static qint64 bucketUpperBound(int bucket);
+
+    QList<qint64> m_buckets;
+    qint64 m_count;
+    qint64 m_max;
+};
+
+} // namespace WinBrowserQt
+
+#endif // LATENCYHISTOGRAM_H
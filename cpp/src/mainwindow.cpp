@@ -1,5 +1,6 @@
 
 #include "mainwindow.h"
+#include "models/stringpool.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QMenuBar>
@@ -10,6 +11,8 @@
 #include <QWebEngineNewWindowRequest>
 #include <QHostAddress>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QProgressDialog>
 #include <QApplication>
 #include <QScreen>
 #include <QMetaObject>
@@ -34,12 +37,27 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
-    // 保存所有数据（使用异步方式）
+    // 先停止导入线程，已经交出的批次在下面一起保存
+    delete m_importer;
+    // 调试构建总是输出输入延迟；发布构建设置 WINBROWSER_LATENCY_STATS 后输出，便于在实际构建上对比
+#ifdef NDEBUG
+    const bool logLatency = qEnvironmentVariableIsSet("WINBROWSER_LATENCY_STATS");
+#else
+    const bool logLatency = true;
+#endif
+    if (logLatency) {
+        m_addressBar->logLatencyStats();
+    }
+
+    // 保存所有数据：交给写入线程合并后在限定时间内写出
     if (m_storageManager) {
+        // 尚未发出的历史记录变化先写入日志
+        m_navigationManager->flushHistoryChanges();
         Settings settings = m_storageManager->loadSettings();
         m_storageManager->saveSettingsAsync(settings);
-        m_storageManager->saveBookmarksAsync(m_bookmarks);
-        m_storageManager->saveHistoryAsync(m_history);
+        m_storageManager->saveBookmarksAsync(m_bookmarks.snapshot());
+        // 历史记录已经通过增量日志实时持久化，无需整体重写
+        m_storageManager->flush(SHUTDOWN_FLUSH_TIMEOUT_MS);
     }
 }
 
@@ -47,6 +65,8 @@ void MainWindow::initializeManagers()
 {
     m_navigationManager = new NavigationManager(this);
     m_storageManager = new StorageManager(this);
+    m_navigationManager->setStorageManager(m_storageManager);
+    m_navigationManager->setBackForwardCapacity(m_storageManager->loadSettings().backForwardCapacity());
 
     // 连接历史记录变化信号
     connect(m_navigationManager, &NavigationManager::historyChanged,
@@ -136,6 +156,8 @@ void MainWindow::createToolbar()
 void MainWindow::createAddressBar()
 {
     m_addressBar = new AddressBar(this);
+    m_addressBar->setNavigationManager(m_navigationManager);
+    m_addressBar->setRemoteSuggestionEndpoint(m_storageManager->loadSettings().searchSuggestUrl());
 
     connect(m_addressBar, &AddressBar::navigateRequested,
             this, &MainWindow::onNavigateRequested);
@@ -170,6 +192,15 @@ void MainWindow::createMenus()
     newTabAction->setShortcut(QKeySequence::New);
     connect(newTabAction, &QAction::triggered, this, [this]() { createNewTab(); });
 
+    QAction *importAction = fileMenu->addAction("导入书签和历史记录(&I)...");
+    connect(importAction, &QAction::triggered, this, &MainWindow::importBrowserData);
+
+    QAction *exportDataAction = fileMenu->addAction("导出数据为 JSON(&E)...");
+    connect(exportDataAction, &QAction::triggered, this, &MainWindow::exportDataToJson);
+
+    QAction *restoreDataAction = fileMenu->addAction("从 JSON 恢复数据(&R)...");
+    connect(restoreDataAction, &QAction::triggered, this, &MainWindow::importDataFromJson);
+
     fileMenu->addSeparator();
 
     QAction *exitAction = fileMenu->addAction("退出(&X)");
@@ -212,6 +243,10 @@ void MainWindow::createMenus()
 
 void MainWindow::onNavigateRequested(const QString &url)
 {
+    // 地址栏输入的访问在 frecency 中加权
+    if (m_currentTab && m_currentTab->navigationSession()) {
+        m_currentTab->navigationSession()->markTypedNavigation();
+    }
     navigateToUrl(url);
 }
 
@@ -236,6 +271,8 @@ void MainWindow::onTabCreated(BrowserTab *tab)
     settings->setAttribute(QWebEngineSettings::LocalStorageEnabled, true);
     settings->setAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls, true);
 
+    tab->setNavigationSession(m_navigationManager->createSession(tab->id()));
+
     // 连接页面信号
     connect(page, &QWebEnginePage::loadStarted, this, [this, tab]() {
         if (m_currentTab == tab) {
@@ -264,8 +301,8 @@ void MainWindow::onTabCreated(BrowserTab *tab)
         if (m_currentTab == tab) {
             m_addressBar->setUrl(url.toString());
         }
-        // 添加到历史记录
-        m_navigationManager->addToHistory(url.toString(), tab->title());
+        // 添加到全局历史记录和这个标签页的会话
+        m_navigationManager->addToHistory(url.toString(), tab->title(), tab->navigationSession().data());
     });
 
     connect(page, &QWebEnginePage::iconChanged, this, [this, tab](const QIcon &icon) {
@@ -292,14 +329,15 @@ void MainWindow::onTabCreated(BrowserTab *tab)
 void MainWindow::onTabClosed(BrowserTab *tab)
 {
     if (tab) {
-        // 清理资源
+        // 清理资源；导航会话随标签页释放
+        m_navigationManager->closeSession(tab->id());
+        tab->setNavigationSession(QSharedPointer<NavigationSession>());
         if (tab->webView()) {
             delete tab->webView();
         }
 
-        // 异步保存书签和历史记录
-        m_storageManager->saveBookmarksAsync(m_bookmarks);
-        m_storageManager->saveHistoryAsync(m_history);
+        // 异步保存书签；历史记录由增量日志负责
+        m_storageManager->saveBookmarksAsync(m_bookmarks.snapshot());
     }
 }
 
@@ -314,9 +352,10 @@ void MainWindow::onTabChanged(BrowserTab *tab)
     }
 }
 
-void MainWindow::onHistoryChanged(const HistoryChangedEventArgs &args)
+void MainWindow::onHistoryChanged(const HistoryChangeBatch &batch)
 {
-    // 历史记录变化处理
+    // 一帧内的变化合并为一批：内存中的聚合表由导航管理器维护，这里一次追加到增量日志
+    m_storageManager->applyHistoryChanges(batch);
     updateNavigationButtons();
 }
 
@@ -456,11 +495,174 @@ void MainWindow::createNewTab(const QString &url)
 void MainWindow::loadDataLazy()
 {
     // 延迟加载数据，此时窗口已经显示
-    m_bookmarks = m_storageManager->loadBookmarks();
-    m_history = m_storageManager->loadHistory();
+    QList<Bookmark> bookmarks = m_storageManager->loadBookmarks();
+    const bool foldersMigrated = m_bookmarkTree.build(m_storageManager->loadBookmarkFolders(), bookmarks);
+    m_bookmarks = PersistentList<Bookmark>(bookmarks);
+    if (foldersMigrated) {
+        // 旧版本按名称保存的文件夹已转换为文件夹树，写回文件夹和书签的 parentId
+        m_storageManager->saveBookmarkFoldersAsync(m_bookmarkTree.folders());
+        m_storageManager->saveBookmarksAsync(m_bookmarks.snapshot());
+    }
+    m_navigationManager->setBookmarks(bookmarks);
+    m_navigationManager->loadHistory(m_storageManager->loadHistory());
+#ifndef NDEBUG
+    StringPool::instance().logStats();
+#endif
     updateStatus("数据加载完成");
 }
 
+void MainWindow::importBrowserData()
+{
+    if (m_importer) {
+        return;
+    }
+
+    const QString path = QFileDialog::getOpenFileName(this, "导入书签和历史记录", QString(),
+        "书签和历史记录 (*.html *.htm *.json Bookmarks places.sqlite);;所有文件 (*)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    const BrowserImporter::Format format = BrowserImporter::detectFormat(path);
+    if (format == BrowserImporter::Format::Unknown) {
+        QMessageBox::warning(this, "导入失败", "无法识别的文件格式");
+        return;
+    }
+
+    m_importFolderId.clear();
+    m_importedBookmarks = 0;
+    m_importedHistory = 0;
+    m_importer = new BrowserImporter(path, format, this);
+
+    // 非模态进度对话框，导入期间可以继续浏览
+    QProgressDialog *progressDialog = new QProgressDialog(
+        QString("正在从 %1 导入...").arg(BrowserImporter::formatName(format)), "取消", 0, 1000, this);
+    progressDialog->setAttribute(Qt::WA_DeleteOnClose);
+    progressDialog->setMinimumDuration(0);
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+
+    connect(progressDialog, &QProgressDialog::canceled, m_importer, &BrowserImporter::cancel);
+    connect(m_importer, &BrowserImporter::progress, progressDialog, [progressDialog](qint64 done, qint64 total) {
+        progressDialog->setValue(total > 0 ? int(qMin(done, total) * 1000 / total) : 0);
+    });
+    connect(m_importer, &BrowserImporter::importFinished, progressDialog, &QWidget::close);
+    connect(m_importer, &BrowserImporter::batchReady, this, &MainWindow::onImportBatch);
+    connect(m_importer, &BrowserImporter::importFinished, this, &MainWindow::onImportFinished);
+    connect(m_importer, &QThread::finished, m_importer, &QObject::deleteLater);
+
+    progressDialog->show();
+    m_importer->start(QThread::LowPriority);
+}
+
+void MainWindow::exportDataToJson()
+{
+    const QString directory = QFileDialog::getExistingDirectory(this, "导出数据");
+    if (directory.isEmpty()) {
+        return;
+    }
+
+    // 导出的是磁盘上的数据，先把内存中尚未写出的变化写出
+    m_navigationManager->flushHistoryChanges();
+    m_storageManager->saveBookmarksAsync(m_bookmarks.snapshot());
+    m_storageManager->saveBookmarkFoldersAsync(m_bookmarkTree.folders());
+    m_storageManager->flush(SHUTDOWN_FLUSH_TIMEOUT_MS);
+
+    if (m_storageManager->exportToJson(directory)) {
+        updateStatus(QString("数据已导出到 %1").arg(directory));
+    } else {
+        QMessageBox::warning(this, "导出失败", QString("无法写入 %1").arg(directory));
+    }
+}
+
+void MainWindow::importDataFromJson()
+{
+    if (m_importer) {
+        return;
+    }
+
+    const QString directory = QFileDialog::getExistingDirectory(this, "从 JSON 恢复数据");
+    if (directory.isEmpty()) {
+        return;
+    }
+    if (QMessageBox::question(this, "从 JSON 恢复数据", "导出的书签和历史记录将替换当前的数据，是否继续？")
+        != QMessageBox::Yes) {
+        return;
+    }
+
+    // 尚未发出的历史记录变化先写入日志，随恢复一起被替换，不会重放到恢复的数据之上
+    m_navigationManager->flushHistoryChanges();
+    if (!m_storageManager->importFromJson(directory)) {
+        QMessageBox::warning(this, "恢复失败", QString("%1 中没有可以恢复的数据，或写入失败").arg(directory));
+        return;
+    }
+
+    // 从磁盘重新载入书签、文件夹树和历史记录
+    loadDataLazy();
+    updateStatus("数据已恢复");
+}
+
+void MainWindow::onImportBatch(const ImportBatch &batch)
+{
+    bool foldersChanged = !batch.folders.isEmpty();
+    if (m_importFolderId.isEmpty() && (!batch.folders.isEmpty() || !batch.bookmarks.isEmpty())) {
+        const QString source = m_importer ? BrowserImporter::formatName(m_importer->format()) : QString();
+        m_importFolderId = m_bookmarkTree.createFolder(QString("从 %1 导入").arg(source), QString());
+        // 没有文件夹的导入（例如扁平的 HTML 书签）也要保存这个文件夹，否则重启后书签的父节点不存在
+        foldersChanged = true;
+    }
+
+    for (BookmarkFolder folder : batch.folders) {
+        if (m_bookmarkTree.containsFolder(folder.id())) {
+            m_bookmarkTree.renameFolder(folder.id(), folder.title());
+            continue;
+        }
+        if (folder.parentId().isEmpty()) {
+            folder.setParentId(m_importFolderId);
+        }
+        m_bookmarkTree.insertFolder(folder);
+    }
+
+    for (Bookmark bookmark : batch.bookmarks) {
+        if (bookmark.parentId().isEmpty() || !m_bookmarkTree.containsFolder(bookmark.parentId())) {
+            bookmark.setParentId(m_importFolderId);
+        }
+        if (m_bookmarkTree.addBookmark(bookmark.id(), bookmark.parentId())) {
+            bookmark.internStrings();
+            m_bookmarks.append(bookmark);
+            m_navigationManager->addBookmark(bookmark);
+            ++m_importedBookmarks;
+        }
+    }
+
+    // 每批只写出新增的记录；文件夹整体保存由写入线程防抖合并
+    if (!batch.bookmarks.isEmpty()) {
+        m_storageManager->saveBookmarksAsync(m_bookmarks.snapshot());
+    }
+    if (foldersChanged) {
+        m_storageManager->saveBookmarkFoldersAsync(m_bookmarkTree.folders());
+    }
+    if (!batch.history.isEmpty()) {
+        m_navigationManager->importHistory(batch.history);
+        m_importedHistory += int(batch.history.size());
+    }
+
+    if (m_importer) {
+        m_importer->acknowledgeBatch();
+    }
+}
+
+void MainWindow::onImportFinished(bool ok, const QString &error)
+{
+    if (ok) {
+        updateStatus(QString("导入完成: %1 个书签, %2 条历史记录").arg(m_importedBookmarks).arg(m_importedHistory));
+    } else if (error.isEmpty()) {
+        updateStatus(QString("导入已取消: 已导入 %1 个书签, %2 条历史记录").arg(m_importedBookmarks).arg(m_importedHistory));
+    } else {
+        QMessageBox::warning(this, "导入失败", error);
+    }
+}
+
 void MainWindow::onDataSaved()
 {
     // 数据保存成功
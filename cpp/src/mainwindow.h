@@ -7,10 +7,13 @@
 #include <QStatusBar>
 #include <QAction>
 #include <QHostAddress>
+#include <QPointer>
 #include "addressbar.h"
 #include "browsertabwidget.h"
 #include "navigationmanager.h"
 #include "storagemanager.h"
+#include "browserimporter.h"
+#include "models/bookmarktree.h"
 
 namespace WinBrowserQt {
 
@@ -30,10 +33,12 @@ private slots:
     void onTabCreated(BrowserTab *tab);
     void onTabClosed(BrowserTab *tab);
     void onTabChanged(BrowserTab *tab);
-    void onHistoryChanged(const HistoryChangedEventArgs &args);
+    void onHistoryChanged(const HistoryChangeBatch &batch);
     void onDataSaved();
     void onSaveError(const QString &message);
     void loadDataLazy();
+    void onImportBatch(const ImportBatch &batch);
+    void onImportFinished(bool ok, const QString &error);
 
     void onBackClicked();
     void onForwardClicked();
@@ -63,6 +68,10 @@ private:
     void refreshCurrentTab();
     void navigateHome();
     void createNewTab(const QString &url = "about:blank");
+    void importBrowserData();
+    // 与 JSON 之间的导出和恢复（StorageManager::exportToJson / importFromJson），用于备份和迁移
+    void exportDataToJson();
+    void importDataFromJson();
 
     void updateNavigationButtons();
     void updateStatus(const QString &message);
@@ -92,9 +101,18 @@ private:
     // 当前标签页
     BrowserTab *m_currentTab;
 
-    // 数据
-    QList<Bookmark> m_bookmarks;
-    QList<HistoryItem> m_history;
+    // 数据：结构共享列表，保存时只取 O(1) 快照；历史记录由导航管理器按 URL 聚合保存
+    PersistentList<Bookmark> m_bookmarks;
+    BookmarkTree m_bookmarkTree;
+
+    // 正在进行的导入；导入的书签放在 m_importFolderId 文件夹下
+    QPointer<BrowserImporter> m_importer;
+    QString m_importFolderId;
+    int m_importedBookmarks = 0;
+    int m_importedHistory = 0;
+
+    // 退出时等待数据写出的最长时间
+    static const int SHUTDOWN_FLUSH_TIMEOUT_MS = 2000;
 };
 
 } // namespace WinBrowserQt
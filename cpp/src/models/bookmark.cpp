@@ -1,7 +1,25 @@
-
 #include "bookmark.h"
+#include "stringpool.h"
+#include <QHash>
 
 namespace WinBrowserQt {
-// Bookmark类的实现目前仅包含头文件中的内联函数
-// 这里保留文件以便未来扩展功能
+
+void Bookmark::internStrings()
+{
+    StringPool &pool = StringPool::instance();
+    m_title = pool.intern(m_title);
+    m_url = pool.intern(m_url);
+    m_folder = pool.intern(m_folder);
+}
+
+size_t Bookmark::contentHash() const
+{
+    if (!m_hashValid) {
+        m_contentHash = qHashMulti(0, m_id, m_title, m_url, m_folder, m_parentId,
+                                   m_dateAdded.isValid() ? m_dateAdded.toMSecsSinceEpoch() : 0);
+        m_hashValid = true;
+    }
+    return m_contentHash;
+}
+
 } // namespace WinBrowserQt
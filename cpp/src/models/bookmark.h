@@ -13,26 +13,42 @@ public:
     Bookmark() = default;
 
     QString id() const { return m_id; }
-    void setId(const QString &id) { m_id = id; }
+    void setId(const QString &id) { m_id = id; m_hashValid = false; }
 
     QString title() const { return m_title; }
-    void setTitle(const QString &title) { m_title = title; }
+    void setTitle(const QString &title) { m_title = title; m_hashValid = false; }
 
     QString url() const { return m_url; }
-    void setUrl(const QString &url) { m_url = url; }
+    void setUrl(const QString &url) { m_url = url; m_hashValid = false; }
 
+    // 旧版本的文件夹名称路径；文件夹树建立后以 parentId 为准，这里只保留用于显示和兼容
     QString folder() const { return m_folder; }
-    void setFolder(const QString &folder) { m_folder = folder; }
+    void setFolder(const QString &folder) { m_folder = folder; m_hashValid = false; }
+
+    // 所在文件夹的 id（见 BookmarkTree），为空表示位于根文件夹
+    QString parentId() const { return m_parentId; }
+    void setParentId(const QString &parentId) { m_parentId = parentId; m_hashValid = false; }
 
     QDateTime dateAdded() const { return m_dateAdded; }
-    void setDateAdded(const QDateTime &date) { m_dateAdded = date; }
+    void setDateAdded(const QDateTime &date) { m_dateAdded = date; m_hashValid = false; }
+
+    // 把标题、URL 和文件夹替换为字符串池中的共享实例，内容不变，哈希缓存仍然有效
+    void internStrings();
+
+    // 内容哈希，用于判断记录自上次保存后是否被修改；结果会缓存到下次修改为止
+    // 缓存不加锁，只应在修改书签的界面线程调用
+    size_t contentHash() const;
 
 private:
     QString m_id;
     QString m_title;
     QString m_url;
     QString m_folder;
+    QString m_parentId;
     QDateTime m_dateAdded;
+
+    mutable size_t m_contentHash = 0;
+    mutable bool m_hashValid = false;
 };
 
 } // namespace WinBrowserQt
@@ -0,0 +1,36 @@
+#ifndef BOOKMARKFOLDER_H
+#define BOOKMARKFOLDER_H
+
+#include <QString>
+#include <QDateTime>
+
+namespace WinBrowserQt {
+
+// 书签文件夹；parentId 为空表示位于根文件夹下
+class BookmarkFolder
+{
+public:
+    BookmarkFolder() = default;
+
+    QString id() const { return m_id; }
+    void setId(const QString &id) { m_id = id; }
+
+    QString title() const { return m_title; }
+    void setTitle(const QString &title) { m_title = title; }
+
+    QString parentId() const { return m_parentId; }
+    void setParentId(const QString &parentId) { m_parentId = parentId; }
+
+    QDateTime dateAdded() const { return m_dateAdded; }
+    void setDateAdded(const QDateTime &date) { m_dateAdded = date; }
+
+private:
+    QString m_id;
+    QString m_title;
+    QString m_parentId;
+    QDateTime m_dateAdded;
+};
+
+} // namespace WinBrowserQt
+
+#endif // BOOKMARKFOLDER_H
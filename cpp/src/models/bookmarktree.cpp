@@ -0,0 +1,333 @@
+#include "bookmarktree.h"
+#include <QUuid>
+#include <QSet>
+
+namespace WinBrowserQt {
+
+bool BookmarkTree::build(const QList<BookmarkFolder> &folders, QList<Bookmark> &bookmarks)
+{
+    clear();
+    m_folders.reserve(folders.size());
+
+    for (const auto &folder : folders) {
+        if (!folder.id().isEmpty() && !m_folders.contains(folder.id())) {
+            FolderNode node;
+            node.folder = folder;
+            m_folders.insert(folder.id(), node);
+        }
+    }
+
+    // 按文件中的顺序挂到父文件夹下；父文件夹缺失或形成环时挂到根文件夹
+    QSet<QString> linked;
+    for (const auto &folder : folders) {
+        if (folder.id().isEmpty() || linked.contains(folder.id())) {
+            continue;
+        }
+        linked.insert(folder.id());
+        FolderNode *child = node(folder.id());
+
+        QString parentId = child->folder.parentId();
+        if (!parentId.isEmpty() && (!m_folders.contains(parentId) || isInSubtree(parentId, folder.id()))) {
+            parentId.clear();
+            child->folder.setParentId(parentId);
+        }
+        node(parentId)->childFolders.append(folder.id());
+    }
+
+    bool created = false;
+    for (auto &bookmark : bookmarks) {
+        QString parentId = bookmark.parentId();
+        if (parentId.isEmpty() && !bookmark.folder().isEmpty()) {
+            parentId = folderForPath(bookmark.folder(), &created);
+        } else if (!parentId.isEmpty() && !m_folders.contains(parentId)) {
+            parentId.clear();
+        }
+
+        if (bookmark.parentId() != parentId) {
+            bookmark.setParentId(parentId);
+        }
+        addBookmark(bookmark.id(), parentId);
+    }
+
+    return created;
+}
+
+void BookmarkTree::clear()
+{
+    m_root = FolderNode();
+    m_folders.clear();
+    m_bookmarkParents.clear();
+}
+
+bool BookmarkTree::containsFolder(const QString &id) const
+{
+    return id.isEmpty() || m_folders.contains(id);
+}
+
+BookmarkFolder BookmarkTree::folder(const QString &id) const
+{
+    const FolderNode *folderNode = node(id);
+    return folderNode ? folderNode->folder : BookmarkFolder();
+}
+
+QStringList BookmarkTree::childFolders(const QString &folderId) const
+{
+    const FolderNode *folderNode = node(folderId);
+    return folderNode ? folderNode->childFolders : QStringList();
+}
+
+QStringList BookmarkTree::childBookmarks(const QString &folderId) const
+{
+    const FolderNode *folderNode = node(folderId);
+    return folderNode ? folderNode->childBookmarks : QStringList();
+}
+
+int BookmarkTree::bookmarkCount(const QString &folderId, bool recursive) const
+{
+    const FolderNode *folderNode = node(folderId);
+    if (!folderNode) {
+        return 0;
+    }
+    return recursive ? folderNode->subtreeBookmarks : int(folderNode->childBookmarks.size());
+}
+
+QString BookmarkTree::folderPath(const QString &folderId) const
+{
+    QStringList parts;
+    QString id = folderId;
+    while (!id.isEmpty()) {
+        const FolderNode *folderNode = node(id);
+        if (!folderNode) {
+            break;
+        }
+        parts.prepend(folderNode->folder.title());
+        id = folderNode->folder.parentId();
+    }
+    return parts.join('/');
+}
+
+QString BookmarkTree::createFolder(const QString &title, const QString &parentId, const QDateTime &dateAdded)
+{
+    BookmarkFolder folder;
+    folder.setId(QUuid::createUuid().toString());
+    folder.setTitle(title);
+    folder.setParentId(parentId);
+    folder.setDateAdded(dateAdded);
+    return insertFolder(folder) ? folder.id() : QString();
+}
+
+bool BookmarkTree::insertFolder(const BookmarkFolder &folder)
+{
+    if (folder.id().isEmpty() || m_folders.contains(folder.id()) || !containsFolder(folder.parentId())) {
+        return false;
+    }
+
+    FolderNode folderNode;
+    folderNode.folder = folder;
+    m_folders.insert(folder.id(), folderNode);
+    node(folder.parentId())->childFolders.append(folder.id());
+    return true;
+}
+
+bool BookmarkTree::renameFolder(const QString &id, const QString &title)
+{
+    FolderNode *folderNode = id.isEmpty() ? nullptr : node(id);
+    if (!folderNode) {
+        return false;
+    }
+    folderNode->folder.setTitle(title);
+    return true;
+}
+
+bool BookmarkTree::moveFolder(const QString &id, const QString &newParentId)
+{
+    FolderNode *folderNode = id.isEmpty() ? nullptr : node(id);
+    if (!folderNode || !containsFolder(newParentId) || isInSubtree(newParentId, id)) {
+        return false;
+    }
+
+    const QString oldParentId = folderNode->folder.parentId();
+    if (oldParentId == newParentId) {
+        return true;
+    }
+
+    const int count = folderNode->subtreeBookmarks;
+    folderNode->folder.setParentId(newParentId);
+    node(oldParentId)->childFolders.removeOne(id);
+    node(newParentId)->childFolders.append(id);
+
+    addToCounts(oldParentId, -count);
+    addToCounts(newParentId, count);
+    return true;
+}
+
+QStringList BookmarkTree::removeFolder(const QString &id)
+{
+    FolderNode *folderNode = id.isEmpty() ? nullptr : node(id);
+    if (!folderNode) {
+        return QStringList();
+    }
+
+    const QString parentId = folderNode->folder.parentId();
+    addToCounts(parentId, -folderNode->subtreeBookmarks);
+    node(parentId)->childFolders.removeOne(id);
+
+    // 只遍历被删除的子树
+    QStringList removedBookmarks;
+    QStringList pending(id);
+    while (!pending.isEmpty()) {
+        const FolderNode removed = m_folders.take(pending.takeLast());
+        for (const QString &bookmarkId : removed.childBookmarks) {
+            m_bookmarkParents.remove(bookmarkId);
+            removedBookmarks.append(bookmarkId);
+        }
+        pending.append(removed.childFolders);
+    }
+    return removedBookmarks;
+}
+
+bool BookmarkTree::addBookmark(const QString &bookmarkId, const QString &parentId)
+{
+    if (bookmarkId.isEmpty() || m_bookmarkParents.contains(bookmarkId) || !containsFolder(parentId)) {
+        return false;
+    }
+
+    m_bookmarkParents.insert(bookmarkId, parentId);
+    node(parentId)->childBookmarks.append(bookmarkId);
+    addToCounts(parentId, 1);
+    return true;
+}
+
+bool BookmarkTree::moveBookmark(const QString &bookmarkId, const QString &newParentId)
+{
+    auto it = m_bookmarkParents.find(bookmarkId);
+    if (it == m_bookmarkParents.end() || !containsFolder(newParentId)) {
+        return false;
+    }
+
+    const QString oldParentId = it.value();
+    if (oldParentId == newParentId) {
+        return true;
+    }
+
+    it.value() = newParentId;
+    node(oldParentId)->childBookmarks.removeOne(bookmarkId);
+    node(newParentId)->childBookmarks.append(bookmarkId);
+    addToCounts(oldParentId, -1);
+    addToCounts(newParentId, 1);
+    return true;
+}
+
+bool BookmarkTree::removeBookmark(const QString &bookmarkId)
+{
+    auto it = m_bookmarkParents.find(bookmarkId);
+    if (it == m_bookmarkParents.end()) {
+        return false;
+    }
+
+    const QString parentId = it.value();
+    m_bookmarkParents.erase(it);
+    node(parentId)->childBookmarks.removeOne(bookmarkId);
+    addToCounts(parentId, -1);
+    return true;
+}
+
+QList<BookmarkFolder> BookmarkTree::folders() const
+{
+    QList<BookmarkFolder> result;
+    result.reserve(m_folders.size());
+
+    // 广度优先：保存后重新加载时父文件夹总是先出现，子数组顺序保持不变
+    QStringList level = m_root.childFolders;
+    while (!level.isEmpty()) {
+        QStringList next;
+        for (const QString &id : std::as_const(level)) {
+            const FolderNode &folderNode = m_folders[id];
+            result.append(folderNode.folder);
+            next.append(folderNode.childFolders);
+        }
+        level = next;
+    }
+    return result;
+}
+
+BookmarkTree::FolderNode *BookmarkTree::node(const QString &id)
+{
+    if (id.isEmpty()) {
+        return &m_root;
+    }
+    auto it = m_folders.find(id);
+    return it != m_folders.end() ? &it.value() : nullptr;
+}
+
+const BookmarkTree::FolderNode *BookmarkTree::node(const QString &id) const
+{
+    if (id.isEmpty()) {
+        return &m_root;
+    }
+    auto it = m_folders.constFind(id);
+    return it != m_folders.constEnd() ? &it.value() : nullptr;
+}
+
+void BookmarkTree::addToCounts(QString folderId, int delta)
+{
+    // 沿祖先链更新到根文件夹，耗时与深度成正比
+    while (true) {
+        FolderNode *folderNode = node(folderId);
+        if (!folderNode) {
+            return;
+        }
+        folderNode->subtreeBookmarks += delta;
+        if (folderId.isEmpty()) {
+            return;
+        }
+        folderId = folderNode->folder.parentId();
+    }
+}
+
+bool BookmarkTree::isInSubtree(const QString &folderId, const QString &rootId) const
+{
+    // 从 folderId 沿 parentId 向上查找 rootId；步数上限防止损坏数据中的环导致死循环
+    QString id = folderId;
+    for (qsizetype steps = 0; !id.isEmpty() && steps <= m_folders.size(); ++steps) {
+        if (id == rootId) {
+            return true;
+        }
+        const FolderNode *folderNode = node(id);
+        if (!folderNode) {
+            return false;
+        }
+        id = folderNode->folder.parentId();
+    }
+    return !id.isEmpty();
+}
+
+QString BookmarkTree::findChildFolder(const QString &parentId, const QString &title) const
+{
+    const FolderNode *parent = node(parentId);
+    if (!parent) {
+        return QString();
+    }
+    for (const QString &id : parent->childFolders) {
+        if (m_folders[id].folder.title() == title) {
+            return id;
+        }
+    }
+    return QString();
+}
+
+QString BookmarkTree::folderForPath(const QString &path, bool *created)
+{
+    QString parentId;
+    for (const QString &title : path.split('/', Qt::SkipEmptyParts)) {
+        QString id = findChildFolder(parentId, title);
+        if (id.isEmpty()) {
+            id = createFolder(title, parentId);
+            *created = true;
+        }
+        parentId = id;
+    }
+    return parentId;
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,82 @@
+#ifndef BOOKMARKTREE_H
+#define BOOKMARKTREE_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QDateTime>
+#include "bookmark.h"
+#include "bookmarkfolder.h"
+
+namespace WinBrowserQt {
+
+// 书签文件夹树：只保存结构（id 和父子关系），书签内容仍由书签列表保存
+// - 文件夹 id → 节点、书签 id → 父文件夹两个哈希索引
+// - 每个文件夹的子文件夹和子书签各保存在一段连续数组中，并维护子树书签总数
+// 列出文件夹的耗时与结果数量成正比；移动子树、统计数量只沿祖先链更新，与书签总数无关
+// 根文件夹的 id 为空字符串
+class BookmarkTree
+{
+public:
+    BookmarkTree() = default;
+
+    // 由持久化的文件夹和书签建立索引。旧版本的书签只有文件夹名（可以是 "a/b" 形式的路径），
+    // 这里按名称找到或新建对应的文件夹并填写 parentId；返回是否新建了文件夹
+    bool build(const QList<BookmarkFolder> &folders, QList<Bookmark> &bookmarks);
+    void clear();
+
+    bool containsFolder(const QString &id) const;
+    bool containsBookmark(const QString &id) const { return m_bookmarkParents.contains(id); }
+    BookmarkFolder folder(const QString &id) const;
+    QString parentOfBookmark(const QString &bookmarkId) const { return m_bookmarkParents.value(bookmarkId); }
+
+    QStringList childFolders(const QString &folderId) const;
+    QStringList childBookmarks(const QString &folderId) const;
+    int bookmarkCount(const QString &folderId, bool recursive = true) const;
+    // 以 "/" 连接的文件夹名称路径，用于显示和兼容旧版本的 folder 字段
+    QString folderPath(const QString &folderId) const;
+
+    // 新建文件夹并返回 id；父文件夹不存在时返回空字符串
+    QString createFolder(const QString &title, const QString &parentId,
+                         const QDateTime &dateAdded = QDateTime::currentDateTime());
+    // 插入已有 id 的文件夹（导入时使用）；id 已存在或父文件夹不存在时返回 false
+    bool insertFolder(const BookmarkFolder &folder);
+    bool renameFolder(const QString &id, const QString &title);
+    // 移动整个子树：只修改两处子数组和祖先链上的计数，不能移动到自己的子树中
+    bool moveFolder(const QString &id, const QString &newParentId);
+    // 删除文件夹及其子树，返回子树中所有书签的 id，由调用方从书签列表中删除
+    QStringList removeFolder(const QString &id);
+
+    bool addBookmark(const QString &bookmarkId, const QString &parentId);
+    bool moveBookmark(const QString &bookmarkId, const QString &newParentId);
+    bool removeBookmark(const QString &bookmarkId);
+
+    // 父文件夹在前、同级按子数组顺序返回全部文件夹，用于持久化
+    QList<BookmarkFolder> folders() const;
+
+private:
+    struct FolderNode
+    {
+        BookmarkFolder folder;
+        QStringList childFolders;
+        QStringList childBookmarks;
+        int subtreeBookmarks = 0;
+    };
+
+    // QHash 插入时可能重新分配，返回的指针只能在下一次插入前使用
+    FolderNode *node(const QString &id);
+    const FolderNode *node(const QString &id) const;
+    void addToCounts(QString folderId, int delta);
+    bool isInSubtree(const QString &folderId, const QString &rootId) const;
+    QString findChildFolder(const QString &parentId, const QString &title) const;
+    QString folderForPath(const QString &path, bool *created);
+
+    FolderNode m_root;
+    QHash<QString, FolderNode> m_folders;
+    QHash<QString, QString> m_bookmarkParents;
+};
+
+} // namespace WinBrowserQt
+
+#endif // BOOKMARKTREE_H
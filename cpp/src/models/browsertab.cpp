@@ -1,16 +1,27 @@
 
 #include "browsertab.h"
+#include "stringpool.h"
 #include <QUuid>
 
 namespace WinBrowserQt {
 
 BrowserTab::BrowserTab(const QString &id, const QString &url, const QString &title)
     : m_id(id.isEmpty() ? QUuid::createUuid().toString() : id)
-    , m_url(url)
-    , m_title(title)
+    , m_url(StringPool::instance().intern(url))
+    , m_title(StringPool::instance().intern(title))
     , m_isLoading(false)
     , m_webView(nullptr)
 {
 }
 
+void BrowserTab::setUrl(const QString &url)
+{
+    m_url = StringPool::instance().intern(url);
+}
+
+void BrowserTab::setTitle(const QString &title)
+{
+    m_title = StringPool::instance().intern(title);
+}
+
 } // namespace WinBrowserQt
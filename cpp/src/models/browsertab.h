@@ -8,6 +8,8 @@
 
 namespace WinBrowserQt {
 
+class NavigationSession;
+
 class BrowserTab
 {
 public:
@@ -18,11 +20,12 @@ public:
     QString id() const { return m_id; }
     void setId(const QString &id) { m_id = id; }
 
+    // URL 和标题经由字符串池保存，与历史记录、书签共享数据
     QString url() const { return m_url; }
-    void setUrl(const QString &url) { m_url = url; }
+    void setUrl(const QString &url);
 
     QString title() const { return m_title; }
-    void setTitle(const QString &title) { m_title = title; }
+    void setTitle(const QString &title);
 
     bool isLoading() const { return m_isLoading; }
     void setIsLoading(bool loading) { m_isLoading = loading; }
@@ -30,12 +33,17 @@ public:
     QWebEngineView* webView() const { return m_webView; }
     void setWebView(QWebEngineView* view) { m_webView = view; }
 
+    // 这个标签页的前进/后退会话，随标签页一起释放
+    QSharedPointer<NavigationSession> navigationSession() const { return m_navigationSession; }
+    void setNavigationSession(const QSharedPointer<NavigationSession> &session) { m_navigationSession = session; }
+
 private:
     QString m_id;
     QString m_url;
     QString m_title;
     bool m_isLoading;
     QWebEngineView* m_webView;
+    QSharedPointer<NavigationSession> m_navigationSession;
 };
 
 } // namespace WinBrowserQt
@@ -1,9 +1,14 @@
 
 #include "historyitem.h"
-#include <QUuid>
+#include "stringpool.h"
 
 namespace WinBrowserQt {
 
-// HistoryItem类目前只有内联实现，无需额外代码
+void HistoryItem::internStrings()
+{
+    StringPool &pool = StringPool::instance();
+    m_url = pool.intern(m_url);
+    m_title = pool.intern(m_title);
+}
 
 } // namespace WinBrowserQt
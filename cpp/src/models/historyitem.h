@@ -7,26 +7,31 @@
 
 namespace WinBrowserQt {
 
+// 一条历史记录的值；热窗口内的记录由 HistoryStore 按列保存，这里只是返回给调用方的视图，
+// 取值不复制字符串
 class HistoryItem
 {
 public:
     HistoryItem() = default;
 
-    QString id() const { return m_id; }
+    const QString &id() const { return m_id; }
     void setId(const QString &id) { m_id = id; }
 
-    QString url() const { return m_url; }
+    const QString &url() const { return m_url; }
     void setUrl(const QString &url) { m_url = url; }
 
-    QString title() const { return m_title; }
+    const QString &title() const { return m_title; }
     void setTitle(const QString &title) { m_title = title; }
 
-    QDateTime timestamp() const { return m_timestamp; }
+    const QDateTime &timestamp() const { return m_timestamp; }
     void setTimestamp(const QDateTime &timestamp) { m_timestamp = timestamp; }
 
     int visitCount() const { return m_visitCount; }
     void setVisitCount(int count) { m_visitCount = count; }
 
+    // 把 URL 和标题替换为字符串池中的共享实例
+    void internStrings();
+
 private:
     QString m_id;
     QString m_url;
@@ -0,0 +1,248 @@
+#ifndef PERSISTENTLIST_H
+#define PERSISTENTLIST_H
+
+#include <QList>
+#include <memory>
+#include <utility>
+
+namespace WinBrowserQt {
+
+// 结构共享的列表：元素按固定大小分块存放，块指针保存在“脊”数组中
+// - snapshot() 只复制一个共享指针，O(1)，快照之后的修改对快照不可见
+// - append() 只写入快照看不到的槽位，均摊 O(1)，不复制已有元素
+// - replace()/removeAt() 对受影响的块写时复制，未受影响的块继续共享
+// 只允许一个线程修改列表；快照可以交给其他线程只读访问
+template <typename T>
+class PersistentList
+{
+public:
+    static const int CHUNK_SIZE = 64;
+
+private:
+    struct Chunk
+    {
+        T items[CHUNK_SIZE];
+    };
+
+    struct Spine
+    {
+        explicit Spine(int cap)
+            : chunks(new std::shared_ptr<Chunk>[cap])
+            , capacity(cap)
+        {
+        }
+
+        std::unique_ptr<std::shared_ptr<Chunk>[]> chunks;
+        int capacity;
+    };
+
+public:
+    class Snapshot
+    {
+    public:
+        Snapshot() = default;
+
+        int size() const { return m_size; }
+        bool isEmpty() const { return m_size == 0; }
+
+        // 两个快照共享同一个脊且长度相同时内容必然相同（任何修改都会产生新的脊或长度）
+        bool isSameVersion(const Snapshot &other) const
+        {
+            return m_spine == other.m_spine && m_size == other.m_size;
+        }
+
+        const T &at(int index) const
+        {
+            return m_spine->chunks[index / CHUNK_SIZE]->items[index % CHUNK_SIZE];
+        }
+
+        // index 所在的块与 other 共享同一份数据：已共享的块不会再被修改，两个快照都能看到的位置内容相同
+        bool sharesChunk(const Snapshot &other, int index) const
+        {
+            return index < m_size && index < other.m_size
+                && m_spine->chunks[index / CHUNK_SIZE] == other.m_spine->chunks[index / CHUNK_SIZE];
+        }
+        const T &operator[](int index) const { return at(index); }
+
+        class const_iterator
+        {
+        public:
+            const_iterator(const Snapshot *snapshot, int index)
+                : m_snapshot(snapshot), m_index(index) {}
+
+            const T &operator*() const { return m_snapshot->at(m_index); }
+            const T *operator->() const { return &m_snapshot->at(m_index); }
+            const_iterator &operator++() { ++m_index; return *this; }
+            bool operator==(const const_iterator &other) const { return m_index == other.m_index; }
+            bool operator!=(const const_iterator &other) const { return m_index != other.m_index; }
+
+        private:
+            const Snapshot *m_snapshot;
+            int m_index;
+        };
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_size); }
+
+        QList<T> toList() const
+        {
+            QList<T> list;
+            list.reserve(m_size);
+            for (const auto &value : *this) {
+                list.append(value);
+            }
+            return list;
+        }
+
+    private:
+        friend class PersistentList;
+
+        std::shared_ptr<Spine> m_spine;
+        int m_size = 0;
+    };
+
+    using const_iterator = typename Snapshot::const_iterator;
+
+    PersistentList() = default;
+    explicit PersistentList(const QList<T> &values)
+    {
+        ensureChunkCapacity((int(values.size()) + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        for (const auto &value : values) {
+            append(value);
+        }
+    }
+
+    // 两个可写列表共享尾块会互相覆盖，因此只允许移动；共享请使用 snapshot()
+    PersistentList(const PersistentList &) = delete;
+    PersistentList &operator=(const PersistentList &) = delete;
+    PersistentList(PersistentList &&other) noexcept
+        : m_view(std::exchange(other.m_view, Snapshot())) {}
+    PersistentList &operator=(PersistentList &&other) noexcept
+    {
+        m_view = std::exchange(other.m_view, Snapshot());
+        return *this;
+    }
+
+    Snapshot snapshot() const { return m_view; }
+
+    int size() const { return m_view.size(); }
+    bool isEmpty() const { return m_view.isEmpty(); }
+    const T &at(int index) const { return m_view.at(index); }
+    const T &operator[](int index) const { return m_view.at(index); }
+    const_iterator begin() const { return m_view.begin(); }
+    const_iterator end() const { return m_view.end(); }
+    QList<T> toList() const { return m_view.toList(); }
+
+    void append(const T &value)
+    {
+        const int chunkIndex = m_view.m_size / CHUNK_SIZE;
+        const int offset = m_view.m_size % CHUNK_SIZE;
+
+        // 新块所在的槽位不可能被任何快照看到，可以直接写入
+        if (offset == 0) {
+            ensureChunkCapacity(chunkIndex + 1);
+            m_view.m_spine->chunks[chunkIndex] = std::make_shared<Chunk>();
+        }
+
+        m_view.m_spine->chunks[chunkIndex]->items[offset] = value;
+        ++m_view.m_size;
+    }
+
+    void replace(int index, const T &value)
+    {
+        const int chunkIndex = index / CHUNK_SIZE;
+        std::shared_ptr<Chunk> &chunk = m_view.m_spine->chunks[chunkIndex];
+
+        // 没有快照引用时原地修改
+        if (m_view.m_spine.use_count() == 1 && chunk.use_count() == 1) {
+            chunk->items[index % CHUNK_SIZE] = value;
+            return;
+        }
+
+        auto spine = copySpine(m_view.m_spine->capacity, chunkCount());
+        auto copy = std::make_shared<Chunk>(*chunk);
+        copy->items[index % CHUNK_SIZE] = value;
+        spine->chunks[chunkIndex] = copy;
+        m_view.m_spine = spine;
+    }
+
+    void removeAt(int index)
+    {
+        rebuildFrom(index / CHUNK_SIZE, [index](int i, const T &) { return i == index; });
+    }
+
+    template <typename Predicate>
+    int removeIf(Predicate pred)
+    {
+        int first = -1;
+        for (int i = 0; i < m_view.m_size; ++i) {
+            if (pred(m_view.at(i))) {
+                first = i;
+                break;
+            }
+        }
+        if (first < 0) {
+            return 0;
+        }
+
+        const int oldSize = m_view.m_size;
+        rebuildFrom(first / CHUNK_SIZE, [&pred](int, const T &value) { return pred(value); });
+        return oldSize - m_view.m_size;
+    }
+
+    void clear()
+    {
+        m_view = Snapshot();
+    }
+
+private:
+    int chunkCount() const
+    {
+        return (m_view.m_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    }
+
+    std::shared_ptr<Spine> copySpine(int capacity, int chunks) const
+    {
+        auto spine = std::make_shared<Spine>(capacity);
+        for (int i = 0; i < chunks; ++i) {
+            spine->chunks[i] = m_view.m_spine->chunks[i];
+        }
+        return spine;
+    }
+
+    void ensureChunkCapacity(int chunks)
+    {
+        if (!m_view.m_spine) {
+            m_view.m_spine = std::make_shared<Spine>(qMax(4, chunks));
+        } else if (chunks > m_view.m_spine->capacity) {
+            // 脊数组扩容时旧的脊保留给已有快照使用
+            m_view.m_spine = copySpine(qMax(chunks, m_view.m_spine->capacity * 2), chunkCount());
+        }
+    }
+
+    // 从 firstChunk 开始重建后续的块，之前的块继续共享；
+    // 缩短后的槽位可能仍被快照看到，所以不能原地移动元素
+    template <typename Skip>
+    void rebuildFrom(int firstChunk, Skip skip)
+    {
+        const Snapshot old = m_view;
+        m_view.m_spine = std::make_shared<Spine>(old.m_spine->capacity);
+        for (int i = 0; i < firstChunk; ++i) {
+            m_view.m_spine->chunks[i] = old.m_spine->chunks[i];
+        }
+        m_view.m_size = firstChunk * CHUNK_SIZE;
+
+        for (int i = m_view.m_size; i < old.m_size; ++i) {
+            const T &value = old.at(i);
+            if (!skip(i, value)) {
+                append(value);
+            }
+        }
+    }
+
+    Snapshot m_view;
+};
+
+} // namespace WinBrowserQt
+
+#endif // PERSISTENTLIST_H
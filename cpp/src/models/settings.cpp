@@ -1,7 +1,13 @@
-
 #include "settings.h"
+#include <QHash>
 
 namespace WinBrowserQt {
-// Settings类的实现目前仅包含头文件中的内联函数
-// 这里保留文件以便未来扩展功能
+
+size_t Settings::contentHash() const
+{
+    return qHashMulti(0, m_homePage, m_searchEngine, m_searchSuggestUrl, m_downloadPath, m_showBookmarksBar,
+                      m_blockPopups, m_enableJavaScript, m_theme, m_storageBackend,
+                      m_backForwardCapacity);
+}
+
 } // namespace WinBrowserQt
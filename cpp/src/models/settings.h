@@ -17,6 +17,10 @@ public:
     QString searchEngine() const { return m_searchEngine; }
     void setSearchEngine(const QString &engine) { m_searchEngine = engine; }
 
+    // 地址栏远程搜索建议的端点（OpenSearch 建议格式），{searchTerms} 替换为输入；为空时不请求
+    QString searchSuggestUrl() const { return m_searchSuggestUrl; }
+    void setSearchSuggestUrl(const QString &url) { m_searchSuggestUrl = url; }
+
     QString downloadPath() const { return m_downloadPath; }
     void setDownloadPath(const QString &path) { m_downloadPath = path; }
 
@@ -32,14 +36,29 @@ public:
     QString theme() const { return m_theme; }
     void setTheme(const QString &theme) { m_theme = theme; }
 
+    // 历史记录和书签的存储后端："file"（二进制快照 + 增量日志）或 "sqlite"
+    QString storageBackend() const { return m_storageBackend; }
+    void setStorageBackend(const QString &backend) { m_storageBackend = backend; }
+
+    // 前进/后退栈最多保留的条目数
+    int backForwardCapacity() const { return m_backForwardCapacity; }
+    void setBackForwardCapacity(int capacity) { m_backForwardCapacity = capacity; }
+
+    // 内容哈希，用于跳过未修改设置的保存
+    size_t contentHash() const;
+
 private:
     QString m_homePage = "about:blank";
     QString m_searchEngine = "bing";
+    // 远程搜索建议的端点模板，默认为空：输入内容不会发往第三方，需要时在 settings.json 中配置
+    QString m_searchSuggestUrl;
     QString m_downloadPath;
     bool m_showBookmarksBar = true;
     bool m_blockPopups = true;
     bool m_enableJavaScript = true;
     QString m_theme = "system";
+    QString m_storageBackend = "file";
+    int m_backForwardCapacity = 100;
 };
 
 } // namespace WinBrowserQt
@@ -0,0 +1,221 @@
+#include "stringpool.h"
+#include <QMutexLocker>
+#include <QHash>
+#include <QDebug>
+
+namespace WinBrowserQt {
+
+StringPool &StringPool::instance()
+{
+    static StringPool pool;
+    return pool;
+}
+
+StringPool::StringPool()
+    : m_nextHandle(1)
+    , m_insertsSinceCollect(0)
+{
+    // 0 号保留为空字符串
+    m_chunks[0].storeRelease(new Entry[CHUNK_SIZE]);
+}
+
+StringPool::~StringPool()
+{
+    for (auto &chunk : m_chunks) {
+        delete[] chunk.loadRelaxed();
+    }
+}
+
+StringPool::Entry &StringPool::entry(Handle handle) const
+{
+    return m_chunks[handle >> CHUNK_BITS].loadAcquire()[handle & (CHUNK_SIZE - 1)];
+}
+
+QString StringPool::intern(const QString &value)
+{
+    if (value.isEmpty()) {
+        return QString();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    QString pooled;
+    internLocked(value, &pooled);
+    return pooled;
+}
+
+StringPool::Handle StringPool::acquire(const QString &value)
+{
+    if (value.isEmpty()) {
+        return NullHandle;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const Handle handle = internLocked(value, nullptr);
+    if (handle != NullHandle) {
+        ++entry(handle).refs;
+    }
+    return handle;
+}
+
+void StringPool::retain(Handle handle)
+{
+    if (handle == NullHandle) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    ++entry(handle).refs;
+}
+
+void StringPool::release(Handle handle)
+{
+    if (handle == NullHandle) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Entry &e = entry(handle);
+    Q_ASSERT(e.live && e.refs > 0);
+    if (--e.refs == 0 && e.value.isDetached()) {
+        // intern() 返回的副本仍在使用时保留，之后由 collect() 回收
+        freeLocked(handle);
+    }
+}
+
+StringPool::Handle StringPool::find(const QString &value) const
+{
+    if (value.isEmpty()) {
+        return NullHandle;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    return findLocked(value, qHash(value));
+}
+
+QString StringPool::string(Handle handle) const
+{
+    // 调用方持有句柄的引用，这一项不会被释放或复用，读取不需要加锁
+    return handle != NullHandle ? entry(handle).value : QString();
+}
+
+void StringPool::collect()
+{
+    QMutexLocker locker(&m_mutex);
+    collectLocked();
+}
+
+StringPool::Handle StringPool::findLocked(const QString &value, size_t hash) const
+{
+    for (auto it = m_byHash.constFind(hash); it != m_byHash.constEnd() && it.key() == hash; ++it) {
+        if (entry(it.value()).value == value) {
+            return it.value();
+        }
+    }
+    return NullHandle;
+}
+
+StringPool::Handle StringPool::internLocked(const QString &value, QString *pooled)
+{
+    ++m_stats.internCalls;
+
+    const size_t hash = qHash(value);
+    const Handle existing = findLocked(value, hash);
+    if (existing != NullHandle) {
+        ++m_stats.hits;
+        const QString &stored = entry(existing).value;
+        // 数据指针不同说明调用方持有一份重复的缓冲区，替换后即可释放
+        if (stored.constData() != value.constData()) {
+            m_stats.savedBytes += value.size() * qint64(sizeof(QChar));
+        }
+        if (pooled) {
+            *pooled = stored;
+        }
+        return existing;
+    }
+
+    if (++m_insertsSinceCollect >= qMax(MIN_COLLECT_INTERVAL, m_stats.uniqueStrings / 2)) {
+        collectLocked();
+    }
+
+    Handle handle;
+    if (!m_freeHandles.isEmpty()) {
+        handle = m_freeHandles.takeLast();
+    } else {
+        if ((m_nextHandle >> CHUNK_BITS) >= Handle(MAX_CHUNKS)) {
+            qWarning() << "字符串池已满，字符串不再驻留";
+            if (pooled) {
+                *pooled = value;
+            }
+            return NullHandle;
+        }
+        handle = m_nextHandle++;
+        QAtomicPointer<Entry> &chunk = m_chunks[handle >> CHUNK_BITS];
+        if (!chunk.loadRelaxed()) {
+            chunk.storeRelease(new Entry[CHUNK_SIZE]);
+        }
+    }
+
+    Entry &e = entry(handle);
+    e.value = value;
+    e.refs = 0;
+    e.live = true;
+    m_byHash.insert(hash, handle);
+    m_stats.uniqueStrings++;
+    m_stats.poolBytes += value.size() * qint64(sizeof(QChar));
+    if (pooled) {
+        *pooled = e.value;
+    }
+    return handle;
+}
+
+void StringPool::freeLocked(Handle handle)
+{
+    Entry &e = entry(handle);
+    const size_t hash = qHash(e.value);
+    for (auto it = m_byHash.find(hash); it != m_byHash.end() && it.key() == hash; ++it) {
+        if (it.value() == handle) {
+            m_byHash.erase(it);
+            break;
+        }
+    }
+
+    m_stats.uniqueStrings--;
+    m_stats.poolBytes -= e.value.size() * qint64(sizeof(QChar));
+    m_stats.releasedStrings++;
+    e.value = QString();
+    e.live = false;
+    m_freeHandles.append(handle);
+}
+
+void StringPool::collectLocked()
+{
+    m_insertsSinceCollect = 0;
+
+    // 没有句柄引用、且池中的实例是唯一引用（intern() 的调用方都已释放）的字符串可以回收
+    QList<Handle> unused;
+    for (Handle handle : std::as_const(m_byHash)) {
+        const Entry &e = entry(handle);
+        if (e.refs == 0 && e.value.isDetached()) {
+            unused.append(handle);
+        }
+    }
+    for (Handle handle : std::as_const(unused)) {
+        freeLocked(handle);
+    }
+}
+
+StringPool::Stats StringPool::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void StringPool::logStats() const
+{
+    const Stats s = stats();
+    qDebug().nospace() << "字符串池: " << s.uniqueStrings << " 个字符串, "
+                       << s.poolBytes / 1024 << " KB, 驻留 " << s.internCalls << " 次, 命中 "
+                       << s.hits << " 次, 节省约 " << s.savedBytes / 1024 << " KB, 已释放 "
+                       << s.releasedStrings << " 个";
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,89 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QString>
+#include <QList>
+#include <QMultiHash>
+#include <QMutex>
+#include <QAtomicPointer>
+
+namespace WinBrowserQt {
+
+// 全局字符串驻留池：相同内容的字符串只保留一份数据，带引用计数，不再被引用的字符串会被释放
+// - intern() 返回与池中实例共享数据的 QString（隐式共享），模型之间复制不再产生新的缓冲区；
+//   只通过 intern() 驻留的字符串没有句柄引用，池中的实例成为唯一引用后由 collect() 回收
+//   （新字符串累积到一定数量时自动进行）
+// - acquire() 返回 32 位句柄并增加引用计数，持有者用完后必须 release()；计数归零时立即释放字符串，
+//   句柄进入空闲列表复用。句柄在持有期间保持稳定，可用作紧凑的索引键
+// - find() 只查找不驻留，用于按字符串查询索引的场合，不会让查询键常驻内存
+// - string() 不加锁：字符串按块存放，块地址不变，持有句柄的调用方保证该项不会被改写
+// 只应驻留会被反复引用的字符串（热窗口内的历史记录、书签、标签页），冷归档中的记录不进池
+// 可在任意线程调用
+class StringPool
+{
+public:
+    using Handle = quint32;
+    static const Handle NullHandle = 0;
+
+    struct Stats
+    {
+        int uniqueStrings = 0;
+        qint64 poolBytes = 0;       // 池中字符串数据占用
+        qint64 internCalls = 0;
+        qint64 hits = 0;
+        qint64 savedBytes = 0;      // 命中时释放的重复缓冲区大小之和
+        qint64 releasedStrings = 0; // 引用归零或被回收的字符串数
+    };
+
+    static StringPool &instance();
+
+    QString intern(const QString &value);
+    // 空字符串返回 NullHandle，NullHandle 不需要释放
+    Handle acquire(const QString &value);
+    void retain(Handle handle);
+    void release(Handle handle);
+    Handle find(const QString &value) const;
+    QString string(Handle handle) const;
+
+    // 回收只被池本身引用、也没有句柄引用的字符串
+    void collect();
+
+    Stats stats() const;
+    void logStats() const;
+
+private:
+    struct Entry
+    {
+        QString value;
+        quint32 refs = 0;           // 句柄引用计数，不含 intern() 返回的 QString
+        bool live = false;
+    };
+
+    StringPool();
+    ~StringPool();
+    Q_DISABLE_COPY(StringPool)
+
+    Entry &entry(Handle handle) const;
+    Handle findLocked(const QString &value, size_t hash) const;
+    Handle internLocked(const QString &value, QString *pooled);
+    void freeLocked(Handle handle);
+    void collectLocked();
+
+    static const int CHUNK_BITS = 12;
+    static const Handle CHUNK_SIZE = 1u << CHUNK_BITS;
+    static const int MAX_CHUNKS = 1 << 14;
+    // 自上次回收以来新增的字符串达到当前数量的一半（至少这么多）时回收一次，均摊 O(1)
+    static const int MIN_COLLECT_INTERVAL = 4096;
+
+    mutable QMutex m_mutex;
+    QAtomicPointer<Entry> m_chunks[MAX_CHUNKS];     // 下标即句柄，0 号保留为空字符串
+    Handle m_nextHandle;
+    QList<Handle> m_freeHandles;
+    QMultiHash<size_t, Handle> m_byHash;            // 不持有字符串副本，池中实例是唯一的池内引用
+    int m_insertsSinceCollect;
+    Stats m_stats;
+};
+
+} // namespace WinBrowserQt
+
+#endif // STRINGPOOL_H
@@ -1,118 +1,397 @@
 
 #include "navigationmanager.h"
-#include <QUuid>
+#include "storagemanager.h"
 #include <QDateTime>
+#include <QSet>
+#include <utility>
 
 namespace WinBrowserQt {
 
 NavigationManager::NavigationManager(QObject *parent)
     : QObject(parent)
-    , m_currentHistoryIndex(-1)
+    , m_suggestionSearch(new ParallelHistorySearch(this))
+    , m_suggestionLimit(0)
+    , m_lastSearchId(0)
+    , m_changeTimer(new QTimer(this))
+    , m_backForwardCapacity(NavigationStack::DEFAULT_CAPACITY)
+    , m_storageManager(nullptr)
 {
+    connect(m_suggestionSearch, &ParallelHistorySearch::finished,
+            this, &NavigationManager::onSuggestionSearchFinished);
+
+    // 定时器从第一条变化开始计时，之后的变化不再推迟发出
+    m_changeTimer->setSingleShot(true);
+    m_changeTimer->setInterval(CHANGE_COALESCE_MS);
+    connect(m_changeTimer, &QTimer::timeout, this, &NavigationManager::flushHistoryChanges);
 }
 
-void NavigationManager::addToHistory(const QString &url, const QString &title)
+void NavigationManager::flushHistoryChanges()
 {
-    // 如果当前不在历史记录末尾，删除当前位置之后的所有记录
-    if (m_currentHistoryIndex < m_history.size() - 1) {
-        m_history = m_history.mid(0, m_currentHistoryIndex + 1);
+    m_changeTimer->stop();
+    if (m_pendingChanges.isEmpty()) {
+        return;
     }
+    const HistoryChangeBatch batch = std::exchange(m_pendingChanges, HistoryChangeBatch());
+    emit historyChanged(batch);
+}
 
-    HistoryItem item;
-    item.setId(QUuid::createUuid().toString());
-    item.setUrl(url);
-    item.setTitle(title.isEmpty() ? url : title);
-    item.setTimestamp(QDateTime::currentDateTime());
-    item.setVisitCount(1);
+void NavigationManager::queueChange(HistoryChangeType type, const HistoryItem &item)
+{
+    m_pendingChanges.record(type, item);
+    if (!m_changeTimer->isActive()) {
+        m_changeTimer->start();
+    }
+}
 
-    m_history.append(item);
+void NavigationManager::setStorageManager(StorageManager *storageManager)
+{
+    m_storageManager = storageManager;
+}
 
-    // 限制历史记录大小
-    if (m_history.size() > MAX_HISTORY_SIZE) {
-        m_history.removeFirst();
-    } else {
-        m_currentHistoryIndex++;
+void NavigationManager::setBackForwardCapacity(int capacity)
+{
+    m_backForwardCapacity = capacity;
+    for (const auto &weak : std::as_const(m_sessions)) {
+        if (const auto session = weak.toStrongRef()) {
+            session->setCapacity(capacity);
+        }
     }
-
-    emit historyChanged(HistoryChangedEventArgs(item, HistoryChangeType::Added));
 }
 
-bool NavigationManager::canGoBack() const
+QSharedPointer<NavigationSession> NavigationManager::createSession(const QString &tabId)
 {
-    return m_currentHistoryIndex > 0;
+    QSharedPointer<NavigationSession> session(new NavigationSession(tabId, m_backForwardCapacity));
+    m_sessions.insert(tabId, session);
+    return session;
 }
 
-bool NavigationManager::canGoForward() const
+void NavigationManager::closeSession(const QString &tabId)
 {
-    return m_currentHistoryIndex < m_history.size() - 1;
+    m_sessions.remove(tabId);
 }
 
-HistoryItem NavigationManager::goBack()
+void NavigationManager::loadHistory(const QList<HistoryItem> &history)
 {
-    if (canGoBack()) {
-        m_currentHistoryIndex--;
-        return m_history[m_currentHistoryIndex];
+    QStringList mergedIds;
+    QStringList updatedIds;
+    m_historyStore.load(history, &mergedIds, &updatedIds);
+    const QList<HistoryItem> items = m_historyStore.items();
+    m_searchIndex.build(items);
+
+    // 载入的记录只有访问次数和最后访问时间，按时间段估算 frecency
+    m_frecency.clear();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (const auto &item : items) {
+        m_frecency.addVisits(item.id(), item.visitCount(), lastVisitMSecs(item), now);
+    }
+    for (auto it = m_bookmarkedUrls.cbegin(); it != m_bookmarkedUrls.cend(); ++it) {
+        m_frecency.setBookmarked(m_historyStore.idForUrl(it.key()), true);
+    }
+    rebuildSuggestions();
+    rebuildSearchEntries();
+
+    for (const QString &id : std::as_const(mergedIds)) {
+        HistoryItem merged;
+        merged.setId(id);
+        queueChange(HistoryChangeType::Removed, merged);
+    }
+    for (const QString &id : std::as_const(updatedIds)) {
+        queueChange(HistoryChangeType::Updated, m_historyStore.item(id));
     }
-    return HistoryItem();
 }
 
-HistoryItem NavigationManager::goForward()
+void NavigationManager::addToHistory(const QString &url, const QString &title, NavigationSession *session)
 {
-    if (canGoForward()) {
-        m_currentHistoryIndex++;
-        return m_history[m_currentHistoryIndex];
+    // 同一 URL 只保留一条聚合记录，重复访问只增加访问次数
+    bool created = false;
+    const QDateTime now = QDateTime::currentDateTime();
+    const HistoryItem item = m_historyStore.recordVisit(url, title, now, &created);
+    m_searchIndex.update(item);
+
+    const bool typed = session && session->takeTypedNavigation();
+    m_frecency.recordVisit(item.id(), now.toMSecsSinceEpoch(), typed);
+    if (created && isBookmarked(url)) {
+        m_frecency.setBookmarked(item.id(), true);
+    }
+    updateSuggestion(item);
+    updateSearchEntry(item);
+
+    if (session) {
+        session->navigate(item);
     }
-    return HistoryItem();
+
+    queueChange(created ? HistoryChangeType::Added : HistoryChangeType::Updated, item);
 }
 
-HistoryItem NavigationManager::getCurrentHistory() const
+void NavigationManager::importHistory(const QList<HistoryItem> &items)
 {
-    if (m_currentHistoryIndex >= 0 && m_currentHistoryIndex < m_history.size()) {
-        return m_history[m_currentHistoryIndex];
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (const auto &imported : items) {
+        bool created = false;
+        const HistoryItem item = m_historyStore.merge(imported, &created);
+        m_searchIndex.update(item);
+        m_frecency.addVisits(item.id(), imported.visitCount(), lastVisitMSecs(imported), now);
+        if (created && isBookmarked(item.url())) {
+            m_frecency.setBookmarked(item.id(), true);
+        }
+        updateSuggestion(item);
+        updateSearchEntry(item);
+        queueChange(created ? HistoryChangeType::Added : HistoryChangeType::Updated, item);
     }
-    return HistoryItem();
 }
 
 QList<HistoryItem> NavigationManager::getHistory() const
 {
-    return m_history;
+    return m_historyStore.items();
+}
+
+HistoryPage NavigationManager::queryHistory(const HistoryQuery &query, const QString &cursor) const
+{
+    if (cursor.isEmpty()) {
+        return m_historyStore.query(query);
+    }
+
+    HistoryCursor position;
+    if (!HistoryCursor::decode(cursor, query, &position)) {
+        return HistoryPage();
+    }
+    return m_historyStore.query(query, &position);
 }
 
 void NavigationManager::clearHistory()
 {
-    m_history.clear();
-    m_currentHistoryIndex = -1;
-    emit historyChanged(HistoryChangedEventArgs(HistoryItem(), HistoryChangeType::Cleared));
+    m_historyStore.clear();
+    m_searchIndex.clear();
+    m_frecency.clear();
+    rebuildSuggestions();
+    rebuildSearchEntries();
+    for (const auto &weak : std::as_const(m_sessions)) {
+        if (const auto session = weak.toStrongRef()) {
+            session->clear();
+        }
+    }
+    // 清空的记录不应继续留在字符串池中
+    StringPool::instance().collect();
+    queueChange(HistoryChangeType::Cleared, HistoryItem());
 }
 
 bool NavigationManager::removeFromHistory(const QString &id)
 {
-    for (int i = 0; i < m_history.size(); ++i) {
-        if (m_history[i].id() == id) {
-            m_history.removeAt(i);
-            if (m_currentHistoryIndex >= i) {
-                m_currentHistoryIndex--;
+    HistoryItem removed;
+    if (!m_historyStore.remove(id, &removed)) {
+        return false;
+    }
+    m_searchIndex.remove(id);
+    m_frecency.remove(id);
+    removeSearchEntry(id);
+
+    // 书签中的 URL 退回为没有访问记录的书签条目
+    const QString normalized = HistoryStore::normalizeUrl(removed.url());
+    auto bookmark = m_bookmarkedUrls.constFind(normalized);
+    if (bookmark != m_bookmarkedUrls.constEnd()) {
+        updateBookmarkSuggestion(normalized, bookmark.value());
+    } else {
+        m_suggestionTrie.remove(normalized);
+    }
+
+    // 同一 URL 可能在各标签页的栈中出现多次，按 id 索引一并删除
+    for (const auto &weak : std::as_const(m_sessions)) {
+        if (const auto session = weak.toStrongRef()) {
+            session->remove(id);
+        }
+    }
+
+    queueChange(HistoryChangeType::Removed, removed);
+    return true;
+}
+
+quint64 NavigationManager::suggestHistoryAsync(const QString &query, int limit)
+{
+    // 文件后端：冷归档的查询只在锁内复制段列表，可以在线程池中调用
+    ParallelHistorySearch::Fallback fallback;
+    if (m_storageManager && !m_storageManager->hasIndexedSearch()) {
+        StorageManager *storageManager = m_storageManager;
+        fallback = [storageManager](const QString &text, int count) {
+            return storageManager->searchArchivedHistory(text, QDateTime(), QDateTime(), count);
+        };
+    }
+    const quint64 requestId = ++m_lastSearchId;
+    m_suggestionLimit = limit;
+
+    // 索引和搜索列表在界面线程上同步维护，候选 id 直接换算成快照中的位置
+    QList<int> candidates;
+    const bool indexed = m_searchIndex.forEachCandidate(query, m_searchEntries.size() / MIN_INDEX_SELECTIVITY,
+        [this, &candidates](const QString &historyId) {
+            auto it = m_searchEntryById.constFind(historyId);
+            if (it != m_searchEntryById.constEnd()) {
+                candidates.append(it.value());
             }
-            emit historyChanged(HistoryChangedEventArgs(HistoryItem(), HistoryChangeType::Removed));
-            return true;
+        });
+    if (indexed) {
+        m_suggestionSearch->startWithCandidates(requestId, m_searchEntries.snapshot(), candidates, query, limit,
+                                                fallback);
+    } else {
+        m_suggestionSearch->start(requestId, m_searchEntries.snapshot(), query, limit, fallback);
+    }
+    return requestId;
+}
+
+void NavigationManager::onSuggestionSearchFinished(quint64 requestId, const QString &query,
+                                                   const QList<HistoryItem> &results)
+{
+    if (results.size() >= m_suggestionLimit || !m_storageManager || !m_storageManager->hasIndexedSearch()) {
+        emit historySuggestionsReady(requestId, query, results);
+        return;
+    }
+
+    // SQLite 后端：全文索引覆盖全部已持久化的记录，其中也有内存中已匹配的，按 id 去重
+    QList<HistoryItem> merged = results;
+    QSet<QString> seen;
+    for (const auto &item : results) {
+        seen.insert(item.id());
+    }
+    for (const auto &item : m_storageManager->searchHistory(query, m_suggestionLimit)) {
+        if (merged.size() >= m_suggestionLimit) {
+            break;
+        }
+        if (!seen.contains(item.id())) {
+            seen.insert(item.id());
+            merged.append(item);
         }
     }
-    return false;
+    emit historySuggestionsReady(requestId, query, merged);
+}
+
+void NavigationManager::cancelHistorySuggestions()
+{
+    m_suggestionSearch->cancel();
+}
+
+QList<SuggestionTrie::Match> NavigationManager::completeUrl(const QString &input, int limit) const
+{
+    return m_suggestionTrie.complete(input, limit);
+}
+
+QString NavigationManager::inlineCompletion(const QString &input) const
+{
+    return m_suggestionTrie.inlineCompletion(input);
+}
+
+void NavigationManager::setBookmarks(const QList<Bookmark> &bookmarks)
+{
+    for (auto it = m_bookmarkedUrls.cbegin(); it != m_bookmarkedUrls.cend(); ++it) {
+        m_frecency.setBookmarked(m_historyStore.idForUrl(it.key()), false);
+    }
+    m_bookmarkedUrls.clear();
+    for (const auto &bookmark : bookmarks) {
+        const QString normalized = HistoryStore::normalizeUrl(bookmark.url());
+        m_bookmarkedUrls.insert(normalized, bookmark);
+        m_frecency.setBookmarked(m_historyStore.idForUrl(normalized), true);
+    }
+    // 整体替换书签只在启动和批量修改时发生，排序键一并重建
+    rebuildSuggestions();
+    rebuildSearchEntries();
+}
+
+void NavigationManager::addBookmark(const Bookmark &bookmark)
+{
+    const QString normalized = HistoryStore::normalizeUrl(bookmark.url());
+    m_bookmarkedUrls.insert(normalized, bookmark);
+
+    const QString historyId = m_historyStore.idForUrl(normalized);
+    if (historyId.isEmpty()) {
+        updateBookmarkSuggestion(normalized, bookmark);
+        return;
+    }
+    m_frecency.setBookmarked(historyId, true);
+    const HistoryItem item = m_historyStore.item(historyId);
+    updateSuggestion(item);
+    updateSearchEntry(item);
 }
 
-QList<HistoryItem> NavigationManager::searchHistory(const QString &query) const
+bool NavigationManager::isBookmarked(const QString &url) const
 {
-    QList<HistoryItem> results;
-    QString lowerQuery = query.toLower();
+    return !m_bookmarkedUrls.isEmpty() && m_bookmarkedUrls.contains(HistoryStore::normalizeUrl(url));
+}
 
-    for (const auto &item : m_history) {
-        if (item.url().toLower().contains(lowerQuery) ||
-            item.title().toLower().contains(lowerQuery)) {
-            results.append(item);
+void NavigationManager::updateSuggestion(const HistoryItem &item)
+{
+    // 有访问记录的 URL 以历史记录为准，同一 id 会替换之前没有访问记录的书签条目
+    m_suggestionTrie.update(HistoryStore::normalizeUrl(item.url()), item.url(), item.title(),
+                            m_frecency.rank(item.id()));
+}
+
+void NavigationManager::updateBookmarkSuggestion(const QString &normalizedUrl, const Bookmark &bookmark)
+{
+    const qint64 dateAdded = bookmark.dateAdded().isValid() ? bookmark.dateAdded().toMSecsSinceEpoch() : 0;
+    m_suggestionTrie.update(normalizedUrl, bookmark.url(), bookmark.title(),
+                            FrecencyScorer::bookmarkRank(dateAdded));
+}
+
+void NavigationManager::rebuildSuggestions()
+{
+    m_suggestionTrie.clear();
+    for (const auto &item : m_historyStore.items()) {
+        updateSuggestion(item);
+    }
+    for (auto it = m_bookmarkedUrls.cbegin(); it != m_bookmarkedUrls.cend(); ++it) {
+        if (!m_suggestionTrie.contains(it.key())) {
+            updateBookmarkSuggestion(it.key(), it.value());
         }
     }
+}
 
-    return results;
+void NavigationManager::updateSearchEntry(const HistoryItem &item)
+{
+    // 正在进行的搜索持有旧快照，替换和追加只会写时复制受影响的块
+    const ParallelHistorySearch::Entry entry{item, m_frecency.rank(item.id())};
+    auto it = m_searchEntryById.constFind(item.id());
+    if (it != m_searchEntryById.constEnd()) {
+        m_searchEntries.replace(it.value(), entry);
+    } else if (!m_freeSearchEntries.isEmpty()) {
+        const int index = m_freeSearchEntries.takeLast();
+        m_searchEntries.replace(index, entry);
+        m_searchEntryById.insert(item.id(), index);
+    } else {
+        m_searchEntryById.insert(item.id(), m_searchEntries.size());
+        m_searchEntries.append(entry);
+    }
+}
+
+void NavigationManager::removeSearchEntry(const QString &id)
+{
+    auto it = m_searchEntryById.find(id);
+    if (it == m_searchEntryById.end()) {
+        return;
+    }
+    const int index = it.value();
+    m_searchEntryById.erase(it);
+    // 留下空位而不是删除，删除会重建之后的所有块
+    m_searchEntries.replace(index, ParallelHistorySearch::Entry());
+    m_freeSearchEntries.append(index);
+    if (m_freeSearchEntries.size() > qMax<qsizetype>(MIN_SEARCH_ENTRY_COMPACT, m_searchEntries.size() / 2)) {
+        rebuildSearchEntries();
+    }
+}
+
+void NavigationManager::rebuildSearchEntries()
+{
+    // 按最后访问时间升序，排序键相同时较新的记录在前
+    PersistentList<ParallelHistorySearch::Entry> entries;
+    m_searchEntryById.clear();
+    m_searchEntryById.reserve(m_historyStore.size());
+    m_freeSearchEntries.clear();
+    for (const auto &item : m_historyStore.items()) {
+        m_searchEntryById.insert(item.id(), entries.size());
+        entries.append({item, m_frecency.rank(item.id())});
+    }
+    m_searchEntries = std::move(entries);
+}
+
+qint64 NavigationManager::lastVisitMSecs(const HistoryItem &item)
+{
+    // 没有时间的记录（部分导入数据）按最旧的时间段计算
+    return item.timestamp().isValid() ? item.timestamp().toMSecsSinceEpoch() : 0;
 }
 
 } // namespace WinBrowserQt
@@ -4,25 +4,23 @@
 
 #include <QObject>
 #include <QList>
+#include <QHash>
+#include <QSharedPointer>
+#include <QWeakPointer>
+#include <QTimer>
+#include "historystore.h"
+#include "historyindex.h"
+#include "frecencyscorer.h"
+#include "suggestiontrie.h"
+#include "historysearch.h"
+#include "historychanges.h"
+#include "navigationsession.h"
 #include "models/historyitem.h"
+#include "models/bookmark.h"
 
 namespace WinBrowserQt {
 
-enum class HistoryChangeType {
-    Added,
-    Removed,
-    Cleared
-};
-
-class HistoryChangedEventArgs
-{
-public:
-    HistoryItem item;
-    HistoryChangeType changeType;
-
-    HistoryChangedEventArgs(const HistoryItem &i, HistoryChangeType type)
-        : item(i), changeType(type) {}
-};
+class StorageManager;
 
 class NavigationManager : public QObject
 {
@@ -31,24 +29,90 @@ class NavigationManager : public QObject
 public:
     explicit NavigationManager(QObject *parent = nullptr);
 
-    void addToHistory(const QString &url, const QString &title);
-    bool canGoBack() const;
-    bool canGoForward() const;
-    HistoryItem goBack();
-    HistoryItem goForward();
-    HistoryItem getCurrentHistory() const;
+    // 存储层为历史记录建议补充内存之外的记录（冷归档或全文索引）
+    void setStorageManager(StorageManager *storageManager);
+    // 每个标签页前进/后退栈的容量，来自设置中的 backForwardCapacity
+    void setBackForwardCapacity(int capacity);
+
+    // 每个标签页一个导航会话，由标签页持有；管理器只保留弱引用，用于删除历史记录时同步清理
+    QSharedPointer<NavigationSession> createSession(const QString &tabId);
+    void closeSession(const QString &tabId);
+
+    // 历史记录的变化在一帧（CHANGE_COALESCE_MS）内合并，通过 historyChanged 一次发出；
+    // 退出前调用 flushHistoryChanges 立即发出尚未发出的变化
+    void flushHistoryChanges();
+
+    // 载入已持久化的历史记录；旧数据中重复的 URL 合并后通过 historyChanged 回写
+    void loadHistory(const QList<HistoryItem> &history);
+    // 记录一次访问：写入全局历史记录（通过 historyChanged 持久化），并压入所在标签页的会话
+    void addToHistory(const QString &url, const QString &title, NavigationSession *session = nullptr);
+    // 合并从其他浏览器导入的记录，不影响前进/后退栈
+    void importHistory(const QList<HistoryItem> &items);
+    // 全部记录的副本；浏览和导出应使用 queryHistory 分页读取
     QList<HistoryItem> getHistory() const;
+    // 按时间范围、主机、文本过滤并排序，每次返回一页；cursor 取上一页的 nextCursor，为空时从头开始
+    // 游标格式错误或与查询条件不符时返回空页
+    HistoryPage queryHistory(const HistoryQuery &query, const QString &cursor = QString()) const;
     void clearHistory();
     bool removeFromHistory(const QString &id);
-    QList<HistoryItem> searchHistory(const QString &query) const;
+    // 地址栏的历史记录建议：内存中匹配的记录按 frecency 从高到低取前 limit 条，
+    // 结果通过 historySuggestionsReady 返回，返回值为请求编号；新的请求取消尚未完成的上一次请求。
+    // 三个字符以上的查询先在界面线程用 trigram 索引求出候选，线程池只核对和排序候选；更短的查询，
+    // 或索引筛选不掉多少记录（例如 "www"、"com"）时在线程池中并行扫描全部记录。
+    // 内存中的匹配不足 limit 条时由存储层补充更早的记录：
+    // 文件后端查询冷归档（在线程池中），SQLite 后端查询全文索引（数据库连接属于界面线程，扫描完成后同步查询）。
+    // 搜索期间删除的记录可能仍出现在结果中
+    quint64 suggestHistoryAsync(const QString &query, int limit);
+    void cancelHistorySuggestions();
+
+    // 地址栏前缀补全：去掉协议和 "www." 后以输入为前缀的历史记录和书签，按 frecency 从高到低，每次按键调用
+    QList<SuggestionTrie::Match> completeUrl(const QString &input, int limit) const;
+    // 排序最高的前缀匹配补全到下一个 '/' 时需要追加在输入之后的文本，没有时为空
+    QString inlineCompletion(const QString &input) const;
+
+    // 书签中的 URL 在排序时获得加成；没有访问记录的书签也参与前缀补全
+    void setBookmarks(const QList<Bookmark> &bookmarks);
+    void addBookmark(const Bookmark &bookmark);
 
 signals:
-    void historyChanged(const HistoryChangedEventArgs &args);
+    void historyChanged(const HistoryChangeBatch &batch);
+    void historySuggestionsReady(quint64 requestId, const QString &query, const QList<HistoryItem> &results);
 
 private:
-    QList<HistoryItem> m_history;
-    int m_currentHistoryIndex;
-    static const int MAX_HISTORY_SIZE = 100;
+    void queueChange(HistoryChangeType type, const HistoryItem &item);
+    void onSuggestionSearchFinished(quint64 requestId, const QString &query, const QList<HistoryItem> &results);
+    bool isBookmarked(const QString &url) const;
+    void updateSuggestion(const HistoryItem &item);
+    void updateBookmarkSuggestion(const QString &normalizedUrl, const Bookmark &bookmark);
+    void rebuildSuggestions();
+    void updateSearchEntry(const HistoryItem &item);
+    void removeSearchEntry(const QString &id);
+    void rebuildSearchEntries();
+    static qint64 lastVisitMSecs(const HistoryItem &item);
+
+    // 全局历史记录按 URL 聚合；前进/后退栈在各标签页的会话中
+    HistoryStore m_historyStore;
+    HistoryIndex m_searchIndex;
+    FrecencyScorer m_frecency;
+    SuggestionTrie m_suggestionTrie;        // 条目 id 为规范化后的 URL
+    QHash<QString, Bookmark> m_bookmarkedUrls;  // 以规范化后的 URL 为键
+    ParallelHistorySearch *m_suggestionSearch;
+    int m_suggestionLimit;
+    // 并行搜索用的结构共享列表，历史记录或排序键变化时逐条更新，每次搜索取 O(1) 快照；
+    // 删除的记录留下空位，由之后新增的记录复用，空位过多时整体重建
+    PersistentList<ParallelHistorySearch::Entry> m_searchEntries;
+    QHash<QString, int> m_searchEntryById;
+    QList<int> m_freeSearchEntries;
+    quint64 m_lastSearchId;
+    HistoryChangeBatch m_pendingChanges;
+    QTimer *m_changeTimer;
+    QHash<QString, QWeakPointer<NavigationSession>> m_sessions;
+    int m_backForwardCapacity;
+    StorageManager *m_storageManager;
+    static const int CHANGE_COALESCE_MS = 16;
+    static const int MIN_SEARCH_ENTRY_COMPACT = 1024;
+    // 最短的倒排表不超过记录数的这个几分之一时才用索引，否则求交集不比直接扫描省事
+    static const int MIN_INDEX_SELECTIVITY = 4;
 };
 
 } // namespace WinBrowserQt
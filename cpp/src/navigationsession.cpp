@@ -0,0 +1,27 @@
+#include "navigationsession.h"
+
+namespace WinBrowserQt {
+
+NavigationSession::NavigationSession(const QString &tabId, int capacity)
+    : m_tabId(tabId)
+    , m_stack(capacity)
+    , m_typedNavigation(false)
+{
+}
+
+void NavigationSession::navigate(const HistoryItem &item)
+{
+    if (!m_stack.isEmpty() && m_stack.current().id() == item.id()) {
+        return;
+    }
+    m_stack.push(item);
+}
+
+bool NavigationSession::takeTypedNavigation()
+{
+    const bool typed = m_typedNavigation;
+    m_typedNavigation = false;
+    return typed;
+}
+
+} // namespace WinBrowserQt
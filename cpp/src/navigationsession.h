@@ -0,0 +1,45 @@
+#ifndef NAVIGATIONSESSION_H
+#define NAVIGATIONSESSION_H
+
+#include <QString>
+#include "navigationstack.h"
+#include "models/historyitem.h"
+
+namespace WinBrowserQt {
+
+// 单个标签页的导航会话：只保存这个标签页的前进/后退栈
+// 条目是历史记录表中的聚合记录，URL 和标题与其共享字符串池中的数据，每个会话只占一个定长槽位数组
+// 会话随标签页释放；全局的访问流由 NavigationManager 的历史记录表负责持久化
+class NavigationSession
+{
+public:
+    NavigationSession(const QString &tabId, int capacity);
+
+    QString tabId() const { return m_tabId; }
+
+    int capacity() const { return m_stack.capacity(); }
+    void setCapacity(int capacity) { m_stack.setCapacity(capacity); }
+
+    // 记录一次导航；与当前条目是同一条记录时（重定向、刷新）不重复压入
+    void navigate(const HistoryItem &item);
+    // 下一次导航来自地址栏输入；记录访问时取走标记，用于 frecency 加权
+    void markTypedNavigation() { m_typedNavigation = true; }
+    bool takeTypedNavigation();
+    bool remove(const QString &historyId) { return m_stack.remove(historyId); }
+    void clear() { m_stack.clear(); }
+
+    bool canGoBack() const { return m_stack.canGoBack(); }
+    bool canGoForward() const { return m_stack.canGoForward(); }
+    HistoryItem goBack() { return m_stack.goBack(); }
+    HistoryItem goForward() { return m_stack.goForward(); }
+    HistoryItem current() const { return m_stack.current(); }
+
+private:
+    QString m_tabId;
+    NavigationStack m_stack;
+    bool m_typedNavigation;
+};
+
+} // namespace WinBrowserQt
+
+#endif // NAVIGATIONSESSION_H
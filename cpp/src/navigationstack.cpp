@@ -0,0 +1,238 @@
+#include "navigationstack.h"
+
+namespace WinBrowserQt {
+
+NavigationStack::NavigationStack(int capacity)
+    : m_head(0)
+    , m_size(0)
+    , m_current(-1)
+    , m_liveBehind(0)
+    , m_liveAhead(0)
+    , m_nextSerial(1)
+{
+    m_slots.resize(qMax(1, capacity));
+}
+
+void NavigationStack::setCapacity(int capacity)
+{
+    capacity = qMax(1, capacity);
+    if (capacity == this->capacity()) {
+        return;
+    }
+
+    // 按逻辑顺序取出有效条目，保留最新的 capacity 个
+    QList<Slot> live;
+    int currentIndex = -1;
+    for (int i = 0; i < m_size; ++i) {
+        Slot &slot = m_slots[physical(i)];
+        if (!slot.removed) {
+            if (i == m_current) {
+                currentIndex = int(live.size());
+            }
+            live.append(std::move(slot));
+        }
+    }
+    const int first = qMax(0, int(live.size()) - capacity);
+
+    m_slots = QList<Slot>(capacity);
+    m_slotsById.clear();
+    m_head = 0;
+    m_size = int(live.size()) - first;
+    for (int i = 0; i < m_size; ++i) {
+        m_slots[i] = std::move(live[first + i]);
+        m_slotsById[m_slots[i].item.id()].append(SlotRef{i, m_slots[i].serial});
+    }
+
+    m_current = m_size > 0 ? qMax(0, currentIndex - first) : -1;
+    m_liveBehind = qMax(0, m_current);
+    m_liveAhead = m_size > 0 ? m_size - 1 - m_current : 0;
+}
+
+void NavigationStack::push(const HistoryItem &item)
+{
+    if (m_current >= 0) {
+        // 截断前进部分只需要缩小逻辑长度，被丢弃的槽位在复用时再清理索引
+        m_size = m_current + 1;
+        m_liveAhead = 0;
+        m_liveBehind++;
+    }
+
+    if (m_size == capacity()) {
+        // 淘汰最旧的条目
+        Slot &oldest = m_slots[m_head];
+        if (!oldest.removed) {
+            m_liveBehind--;
+        }
+        unindex(m_head);
+        m_head = (m_head + 1) % capacity();
+        m_size--;
+    }
+
+    const int slot = physical(m_size);
+    unindex(slot);
+
+    Slot &target = m_slots[slot];
+    target.item = item;
+    target.serial = m_nextSerial++;
+    target.removed = false;
+    m_slotsById[item.id()].append(SlotRef{slot, target.serial});
+
+    m_current = m_size;
+    m_size++;
+}
+
+bool NavigationStack::remove(const QString &id)
+{
+    const QList<SlotRef> refs = m_slotsById.take(id);
+    bool removedAny = false;
+    bool removedCurrent = false;
+
+    for (const SlotRef &ref : refs) {
+        Slot &slot = m_slots[ref.slot];
+        if (!isValid(ref) || slot.removed) {
+            continue;
+        }
+        slot.removed = true;
+        slot.item = HistoryItem();
+        removedAny = true;
+
+        const int index = logical(ref.slot);
+        if (index < m_current) {
+            m_liveBehind--;
+        } else if (index > m_current) {
+            m_liveAhead--;
+        } else {
+            removedCurrent = true;
+        }
+    }
+
+    if (removedCurrent) {
+        if (m_liveBehind > 0) {
+            step(-1);
+            m_liveBehind--;
+        } else if (m_liveAhead > 0) {
+            step(1);
+            m_liveAhead--;
+        } else {
+            clear();
+            return true;
+        }
+    }
+
+    const int removedCount = m_size - (m_liveBehind + m_liveAhead + 1);
+    if (removedCount * 2 > m_size) {
+        compact();
+    }
+    return removedAny;
+}
+
+void NavigationStack::clear()
+{
+    m_slots.fill(Slot());
+    m_slotsById.clear();
+    m_head = 0;
+    m_size = 0;
+    m_current = -1;
+    m_liveBehind = 0;
+    m_liveAhead = 0;
+}
+
+HistoryItem NavigationStack::goBack()
+{
+    if (!canGoBack()) {
+        return HistoryItem();
+    }
+    m_liveAhead++;
+    step(-1);
+    m_liveBehind--;
+    return current();
+}
+
+HistoryItem NavigationStack::goForward()
+{
+    if (!canGoForward()) {
+        return HistoryItem();
+    }
+    m_liveBehind++;
+    step(1);
+    m_liveAhead--;
+    return current();
+}
+
+HistoryItem NavigationStack::current() const
+{
+    return m_current >= 0 ? m_slots[physical(m_current)].item : HistoryItem();
+}
+
+bool NavigationStack::isValid(const SlotRef &ref) const
+{
+    return m_slots[ref.slot].serial == ref.serial && logical(ref.slot) < m_size;
+}
+
+void NavigationStack::unindex(int slot)
+{
+    const Slot &target = m_slots[slot];
+    if (target.serial == 0 || target.removed) {
+        return;
+    }
+
+    auto it = m_slotsById.find(target.item.id());
+    if (it == m_slotsById.end()) {
+        return;
+    }
+    QList<SlotRef> &refs = it.value();
+    for (qsizetype i = 0; i < refs.size(); ++i) {
+        if (refs[i].slot == slot && refs[i].serial == target.serial) {
+            refs.removeAt(i);
+            break;
+        }
+    }
+    if (refs.isEmpty()) {
+        m_slotsById.erase(it);
+    }
+}
+
+void NavigationStack::step(int direction)
+{
+    // 调用方保证该方向上还有有效条目
+    int index = m_current + direction;
+    while (m_slots[physical(index)].removed) {
+        index += direction;
+    }
+    m_current = index;
+}
+
+void NavigationStack::compact()
+{
+    // 原地把有效条目依次前移，头部位置不变
+    int write = 0;
+    int newCurrent = 0;
+    for (int read = 0; read < m_size; ++read) {
+        Slot &slot = m_slots[physical(read)];
+        if (slot.removed) {
+            slot = Slot();
+            continue;
+        }
+        if (read == m_current) {
+            newCurrent = write;
+        }
+        if (read != write) {
+            m_slots[physical(write)] = std::move(slot);
+            slot = Slot();
+        }
+        ++write;
+    }
+
+    m_size = write;
+    m_current = newCurrent;
+    m_liveBehind = newCurrent;
+    m_liveAhead = write - 1 - newCurrent;
+
+    m_slotsById.clear();
+    for (int i = 0; i < m_size; ++i) {
+        const int slot = physical(i);
+        m_slotsById[m_slots[slot].item.id()].append(SlotRef{slot, m_slots[slot].serial});
+    }
+}
+
+} // namespace WinBrowserQt
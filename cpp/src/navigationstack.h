@@ -0,0 +1,73 @@
+#ifndef NAVIGATIONSTACK_H
+#define NAVIGATIONSTACK_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include "models/historyitem.h"
+
+namespace WinBrowserQt {
+
+// 定长环形缓冲区实现的前进/后退栈
+// - 槽位数组在设置容量时一次分配，之后压入、截断前进部分、淘汰最旧条目都只移动下标
+// - id → 槽位索引（同一 id 可以出现多次），按 id 删除只标记这些槽位，不移动其他条目
+// - 记录当前位置前后的有效条目数，canGoBack/canGoForward 为 O(1)
+// 被删除的条目在压缩前仍占用槽位；超过一半时原地压缩一次，均摊后删除仍为 O(1)
+class NavigationStack
+{
+public:
+    explicit NavigationStack(int capacity = DEFAULT_CAPACITY);
+
+    int capacity() const { return int(m_slots.size()); }
+    // 缩小容量时保留最新的条目
+    void setCapacity(int capacity);
+
+    // 压入新条目：丢弃当前位置之后的条目，已满时淘汰最旧的条目
+    void push(const HistoryItem &item);
+    // 删除某个 id 的全部条目；删除的是当前条目时当前位置移到相邻的条目
+    bool remove(const QString &id);
+    void clear();
+
+    bool isEmpty() const { return m_current < 0; }
+    bool canGoBack() const { return m_liveBehind > 0; }
+    bool canGoForward() const { return m_liveAhead > 0; }
+    HistoryItem goBack();
+    HistoryItem goForward();
+    HistoryItem current() const;
+
+    static const int DEFAULT_CAPACITY = 100;
+
+private:
+    struct Slot
+    {
+        HistoryItem item;
+        quint64 serial = 0;     // 0 表示空槽位；索引中的引用按序号判断是否过期
+        bool removed = true;
+    };
+
+    struct SlotRef
+    {
+        int slot;
+        quint64 serial;
+    };
+
+    int physical(int logical) const { return (m_head + logical) % capacity(); }
+    int logical(int physical) const { return (physical - m_head + capacity()) % capacity(); }
+    bool isValid(const SlotRef &ref) const;
+    void unindex(int slot);
+    void step(int direction);
+    void compact();
+
+    QList<Slot> m_slots;
+    QHash<QString, QList<SlotRef>> m_slotsById;
+    int m_head;         // 最旧条目所在的槽位
+    int m_size;         // 逻辑条目数，包括已删除的
+    int m_current;      // 当前条目的逻辑位置，栈为空时为 -1；不为空时总是指向有效条目
+    int m_liveBehind;
+    int m_liveAhead;
+    quint64 m_nextSerial;
+};
+
+} // namespace WinBrowserQt
+
+#endif // NAVIGATIONSTACK_H
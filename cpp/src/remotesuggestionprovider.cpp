@@ -0,0 +1,147 @@
+#include "remotesuggestionprovider.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QUrl>
+
+namespace WinBrowserQt {
+
+RemoteSuggestionProvider::RemoteSuggestionProvider(QNetworkAccessManager *network, QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_timeoutMs(DEFAULT_TIMEOUT_MS)
+    , m_cache(CACHE_CAPACITY)
+{
+}
+
+RemoteSuggestionProvider::~RemoteSuggestionProvider()
+{
+    cancel();
+}
+
+void RemoteSuggestionProvider::setEndpoint(const QString &urlTemplate)
+{
+    if (urlTemplate == m_endpoint) {
+        return;
+    }
+    // 换了端点，旧的结果不再有效
+    cancel();
+    m_cache.clear();
+    m_endpoint = urlTemplate;
+}
+
+void RemoteSuggestionProvider::request(const QString &query)
+{
+    m_query = query;
+    const QString key = normalizeQuery(query);
+    if (key.isEmpty() || m_endpoint.isEmpty()) {
+        cancel();
+        return;
+    }
+
+    if (const QStringList *cached = m_cache.object(key)) {
+        cancel();
+        emit suggestionsReady(query, *cached, false);
+        return;
+    }
+
+    // 同一前缀的请求还在进行，完成后按最新的输入发出
+    if (m_reply && m_replyKey == key) {
+        return;
+    }
+    cancel();
+
+    // 更短前缀的结果中仍然匹配的部分先用上
+    for (qsizetype length = key.size() - 1; length > 0; --length) {
+        const QStringList *shorter = m_cache.object(key.left(length));
+        if (!shorter) {
+            continue;
+        }
+        QStringList filtered;
+        for (const QString &suggestion : *shorter) {
+            if (normalizeQuery(suggestion).startsWith(key)) {
+                filtered.append(suggestion);
+            }
+        }
+        if (!filtered.isEmpty()) {
+            emit suggestionsReady(query, filtered, true);
+        }
+        break;
+    }
+
+    QString target = m_endpoint;
+    target.replace(QLatin1String("{searchTerms}"), QString::fromUtf8(QUrl::toPercentEncoding(key)));
+    QNetworkRequest networkRequest{QUrl(target)};
+    networkRequest.setTransferTimeout(m_timeoutMs);
+
+    QNetworkReply *reply = m_network->get(networkRequest);
+    m_reply = reply;
+    m_replyKey = key;
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        onReplyFinished(reply);
+    });
+}
+
+void RemoteSuggestionProvider::cancel()
+{
+    if (!m_reply) {
+        return;
+    }
+    // 先清空再中止：abort 会同步触发 finished，此时已不是当前请求
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    m_replyKey.clear();
+    reply->abort();
+}
+
+void RemoteSuggestionProvider::onReplyFinished(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (reply != m_reply) {
+        return;
+    }
+
+    const QString key = m_replyKey;
+    m_reply = nullptr;
+    m_replyKey.clear();
+    if (reply->error() != QNetworkReply::NoError) {
+        return;
+    }
+
+    const QStringList suggestions = parseResponse(reply->readAll());
+    m_cache.insert(key, new QStringList(suggestions));
+    // 合并的请求之后输入可能只在空白或大小写上有变化，按最新的输入发出
+    if (normalizeQuery(m_query) == key) {
+        emit suggestionsReady(m_query, suggestions, false);
+    }
+}
+
+QString RemoteSuggestionProvider::normalizeQuery(const QString &query)
+{
+    return query.simplified().toLower();
+}
+
+QStringList RemoteSuggestionProvider::parseResponse(const QByteArray &data)
+{
+    QStringList suggestions;
+    const QJsonDocument document = QJsonDocument::fromJson(data);
+    if (!document.isArray()) {
+        return suggestions;
+    }
+
+    const QJsonArray values = document.array().at(1).toArray();
+    for (const QJsonValue &value : values) {
+        const QString suggestion = value.toString().trimmed();
+        if (!suggestion.isEmpty()) {
+            suggestions.append(suggestion);
+            if (suggestions.size() >= MAX_SUGGESTIONS) {
+                break;
+            }
+        }
+    }
+    return suggestions;
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,69 @@
+#ifndef REMOTESUGGESTIONPROVIDER_H
+#define REMOTESUGGESTIONPROVIDER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QCache>
+#include <QPointer>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace WinBrowserQt {
+
+// 远程搜索建议，端点返回 OpenSearch 建议格式：["输入", ["建议1", "建议2", ...], ...]
+// - 端点是 URL 模板，{searchTerms} 替换为编码后的输入，为空时不发出请求；
+//   可以指向本机的 HTTP 替身（自带延迟）做测试，网络访问管理器也由调用方提供
+// - 结果按规范化的前缀（合并空白、小写）缓存在容量固定的 LRU 中；未命中时如果缓存中有当前前缀的
+//   更短前缀，先把其中仍以当前前缀开头的建议作为临时结果发出，请求完成后再发出最终结果
+// - 同一时刻最多一个请求：前缀相同的请求合并到进行中的请求，前缀不同时中止旧的 QNetworkReply
+// - 请求完全异步，不阻塞调用方；超时、出错或被中止的请求不发出结果
+class RemoteSuggestionProvider : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RemoteSuggestionProvider(QNetworkAccessManager *network, QObject *parent = nullptr);
+    ~RemoteSuggestionProvider();
+
+    void setEndpoint(const QString &urlTemplate);
+    QString endpoint() const { return m_endpoint; }
+    bool isEnabled() const { return !m_endpoint.isEmpty(); }
+    void setTimeout(int msecs) { m_timeoutMs = msecs; }
+
+    // 缓存命中时在调用中直接发出 suggestionsReady
+    void request(const QString &query);
+    // 中止进行中的请求
+    void cancel();
+    void clearCache() { m_cache.clear(); }
+
+    static QString normalizeQuery(const QString &query);
+    static QStringList parseResponse(const QByteArray &data);
+
+    static const int CACHE_CAPACITY = 256;
+    static const int DEFAULT_TIMEOUT_MS = 2000;
+    // 每个前缀最多保留的建议数
+    static const int MAX_SUGGESTIONS = 10;
+
+signals:
+    // provisional 为 true 时结果来自更短前缀的缓存，之后还会发出最终结果（请求失败时除外）
+    void suggestionsReady(const QString &query, const QStringList &suggestions, bool provisional);
+
+private:
+    void onReplyFinished(QNetworkReply *reply);
+
+    QNetworkAccessManager *m_network;
+    QString m_endpoint;
+    int m_timeoutMs;
+
+    QPointer<QNetworkReply> m_reply;
+    QString m_replyKey;
+    QString m_query;            // 最近一次请求的输入，结果按它发出
+
+    QCache<QString, QStringList> m_cache;
+};
+
+} // namespace WinBrowserQt
+
+#endif // REMOTESUGGESTIONPROVIDER_H
@@ -0,0 +1,449 @@
+#include "sqlitestore.h"
+#include <QSqlError>
+#include <QVariant>
+#include <QDebug>
+
+namespace WinBrowserQt {
+
+SqliteStore::SqliteStore()
+    : m_connectionName(QString("winbrowser_store_%1").arg(quintptr(this), 0, 16))
+    , m_hasFts(false)
+    , m_batchDepth(0)
+{
+}
+
+SqliteStore::~SqliteStore()
+{
+    close();
+}
+
+bool SqliteStore::open(const QString &path)
+{
+    close();
+
+    m_db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    m_db.setDatabaseName(path);
+    if (!m_db.open()) {
+        qWarning() << "打开 SQLite 数据库失败:" << path << m_db.lastError().text();
+        close();
+        return false;
+    }
+
+    // WAL 模式下写入不阻塞读取；NORMAL 同步级别在 WAL 下仍能保证崩溃后数据库一致
+    exec("PRAGMA journal_mode=WAL");
+    exec("PRAGMA synchronous=NORMAL");
+    exec("PRAGMA temp_store=MEMORY");
+
+    if (!createSchema()) {
+        close();
+        return false;
+    }
+
+    m_insertHistory = QSqlQuery(m_db);
+    m_updateHistory = QSqlQuery(m_db);
+    m_removeHistory = QSqlQuery(m_db);
+    m_putBookmark = QSqlQuery(m_db);
+    m_removeBookmark = QSqlQuery(m_db);
+
+    const bool prepared =
+        prepare(m_insertHistory,
+                "INSERT OR IGNORE INTO history (id, url, title, timestamp, visit_count) "
+                "VALUES (?, ?, ?, ?, ?)")
+        // 按 URL 聚合后的再次访问：整条覆盖，保留原有 seq
+        && prepare(m_updateHistory,
+                   "INSERT INTO history (id, url, title, timestamp, visit_count) VALUES (?, ?, ?, ?, ?) "
+                   "ON CONFLICT(id) DO UPDATE SET url = excluded.url, title = excluded.title, "
+                   "timestamp = excluded.timestamp, visit_count = excluded.visit_count")
+        && prepare(m_removeHistory, "DELETE FROM history WHERE id = ?")
+        // UPSERT 保留原有 seq，书签顺序不变
+        && prepare(m_putBookmark,
+                   "INSERT INTO bookmarks (id, title, url, folder, date_added, parent_id) "
+                   "VALUES (?, ?, ?, ?, ?, ?) "
+                   "ON CONFLICT(id) DO UPDATE SET title = excluded.title, url = excluded.url, "
+                   "folder = excluded.folder, date_added = excluded.date_added, parent_id = excluded.parent_id")
+        && prepare(m_removeBookmark, "DELETE FROM bookmarks WHERE id = ?");
+
+    if (!prepared) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SqliteStore::close()
+{
+    m_insertHistory = QSqlQuery();
+    m_updateHistory = QSqlQuery();
+    m_removeHistory = QSqlQuery();
+    m_putBookmark = QSqlQuery();
+    m_removeBookmark = QSqlQuery();
+    m_batchDepth = 0;
+
+    if (m_db.isValid()) {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+}
+
+bool SqliteStore::isOpen() const
+{
+    return m_db.isValid() && m_db.isOpen();
+}
+
+bool SqliteStore::createSchema()
+{
+    const bool tables =
+        exec("CREATE TABLE IF NOT EXISTS history ("
+             "seq INTEGER PRIMARY KEY, id TEXT NOT NULL UNIQUE, url TEXT NOT NULL, "
+             "title TEXT, timestamp INTEGER, visit_count INTEGER NOT NULL DEFAULT 1)")
+        && exec("CREATE INDEX IF NOT EXISTS history_timestamp ON history (timestamp)")
+        && exec("CREATE TABLE IF NOT EXISTS bookmarks ("
+                "seq INTEGER PRIMARY KEY, id TEXT NOT NULL UNIQUE, title TEXT, "
+                "url TEXT NOT NULL, folder TEXT, date_added INTEGER, parent_id TEXT)")
+        && exec("CREATE TABLE IF NOT EXISTS bookmark_folders ("
+                "seq INTEGER PRIMARY KEY, id TEXT NOT NULL UNIQUE, title TEXT, "
+                "parent_id TEXT, date_added INTEGER)");
+    if (!tables) {
+        return false;
+    }
+
+    // 文件夹树之前创建的数据库没有 parent_id 列
+    if (!hasColumn("bookmarks", "parent_id") && !exec("ALTER TABLE bookmarks ADD COLUMN parent_id TEXT")) {
+        return false;
+    }
+
+    // 书签不做全文搜索，之前版本创建的书签全文索引和触发器只会拖慢每次写入
+    exec("DROP TRIGGER IF EXISTS bookmarks_ai");
+    exec("DROP TRIGGER IF EXISTS bookmarks_ad");
+    exec("DROP TRIGGER IF EXISTS bookmarks_au");
+    exec("DROP TABLE IF EXISTS bookmarks_fts");
+
+    // trigram 分词器支持任意子串匹配；SQLite 未启用 FTS5 时退回 LIKE 扫描
+    m_hasFts =
+        exec("CREATE VIRTUAL TABLE IF NOT EXISTS history_fts USING fts5("
+             "url, title, content='history', content_rowid='seq', tokenize='trigram')");
+
+    if (m_hasFts) {
+        m_hasFts =
+            exec("CREATE TRIGGER IF NOT EXISTS history_ai AFTER INSERT ON history BEGIN "
+                 "INSERT INTO history_fts (rowid, url, title) VALUES (new.seq, new.url, new.title); END")
+            && exec("CREATE TRIGGER IF NOT EXISTS history_ad AFTER DELETE ON history BEGIN "
+                    "INSERT INTO history_fts (history_fts, rowid, url, title) "
+                    "VALUES ('delete', old.seq, old.url, old.title); END")
+            && exec("CREATE TRIGGER IF NOT EXISTS history_au AFTER UPDATE ON history BEGIN "
+                    "INSERT INTO history_fts (history_fts, rowid, url, title) "
+                    "VALUES ('delete', old.seq, old.url, old.title); "
+                    "INSERT INTO history_fts (rowid, url, title) VALUES (new.seq, new.url, new.title); END");
+    } else {
+        qWarning() << "SQLite 不支持 FTS5，历史记录搜索将使用 LIKE 扫描";
+    }
+
+    return true;
+}
+
+bool SqliteStore::needsMigration()
+{
+    QSqlQuery query(m_db);
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        return query.value(0).toInt() < MIGRATED_VERSION;
+    }
+    return true;
+}
+
+bool SqliteStore::markMigrated()
+{
+    return exec(QString("PRAGMA user_version = %1").arg(MIGRATED_VERSION));
+}
+
+bool SqliteStore::beginBatch()
+{
+    if (m_batchDepth++ == 0) {
+        return m_db.transaction();
+    }
+    return true;
+}
+
+bool SqliteStore::commitBatch()
+{
+    if (m_batchDepth <= 0) {
+        return false;
+    }
+    if (--m_batchDepth == 0) {
+        if (!m_db.commit()) {
+            qWarning() << "提交 SQLite 事务失败:" << m_db.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+    }
+    return true;
+}
+
+QList<HistoryItem> SqliteStore::loadHistory(const QDateTime &since)
+{
+    QList<HistoryItem> history;
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    if (since.isValid()) {
+        // 时间戳列有索引；没有时间戳的记录始终加载
+        query.prepare("SELECT id, url, title, timestamp, visit_count FROM history "
+                      "WHERE timestamp IS NULL OR timestamp >= ? ORDER BY seq");
+        query.addBindValue(since.toMSecsSinceEpoch());
+    } else {
+        query.prepare("SELECT id, url, title, timestamp, visit_count FROM history ORDER BY seq");
+    }
+    if (query.exec()) {
+        while (query.next()) {
+            history.append(historyFromQuery(query));
+        }
+    }
+    return history;
+}
+
+bool SqliteStore::insertHistory(const HistoryItem &item)
+{
+    return execHistory(m_insertHistory, item);
+}
+
+bool SqliteStore::updateHistory(const HistoryItem &item)
+{
+    return execHistory(m_updateHistory, item);
+}
+
+bool SqliteStore::execHistory(QSqlQuery &query, const HistoryItem &item)
+{
+    query.bindValue(0, item.id());
+    query.bindValue(1, item.url());
+    query.bindValue(2, item.title());
+    query.bindValue(3, item.timestamp().isValid()
+                           ? QVariant(item.timestamp().toMSecsSinceEpoch()) : QVariant());
+    query.bindValue(4, item.visitCount());
+    if (!query.exec()) {
+        qWarning() << "写入历史记录失败:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SqliteStore::insertHistory(const QList<HistoryItem> &history)
+{
+    beginBatch();
+    bool ok = true;
+    for (const auto &item : history) {
+        ok = insertHistory(item) && ok;
+    }
+    return commitBatch() && ok;
+}
+
+bool SqliteStore::removeHistory(const QString &id)
+{
+    m_removeHistory.bindValue(0, id);
+    return m_removeHistory.exec();
+}
+
+bool SqliteStore::clearHistory()
+{
+    return exec("DELETE FROM history");
+}
+
+QList<HistoryItem> SqliteStore::searchHistory(const QString &query, int limit)
+{
+    QList<HistoryItem> results;
+    const QString trimmed = query.trimmed();
+    if (trimmed.isEmpty()) {
+        return results;
+    }
+
+    QSqlQuery sql(m_db);
+    sql.setForwardOnly(true);
+
+    // trigram 索引只能匹配至少 3 个字符的子串
+    if (m_hasFts && trimmed.size() >= 3) {
+        sql.prepare("SELECT h.id, h.url, h.title, h.timestamp, h.visit_count "
+                    "FROM history_fts JOIN history h ON h.seq = history_fts.rowid "
+                    "WHERE history_fts MATCH ? ORDER BY h.seq DESC LIMIT ?");
+        sql.addBindValue(ftsPhrase(trimmed));
+    } else {
+        sql.prepare("SELECT id, url, title, timestamp, visit_count FROM history "
+                    "WHERE url LIKE ? ESCAPE '\\' OR title LIKE ? ESCAPE '\\' "
+                    "ORDER BY seq DESC LIMIT ?");
+        sql.addBindValue(likePattern(trimmed));
+        sql.addBindValue(likePattern(trimmed));
+    }
+    sql.addBindValue(limit);
+
+    if (!sql.exec()) {
+        qWarning() << "搜索历史记录失败:" << sql.lastError().text();
+        return results;
+    }
+    while (sql.next()) {
+        results.append(historyFromQuery(sql));
+    }
+    return results;
+}
+
+QList<Bookmark> SqliteStore::loadBookmarks()
+{
+    QList<Bookmark> bookmarks;
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    if (query.exec("SELECT id, title, url, folder, date_added, parent_id FROM bookmarks ORDER BY seq")) {
+        while (query.next()) {
+            bookmarks.append(bookmarkFromQuery(query));
+        }
+    }
+    return bookmarks;
+}
+
+bool SqliteStore::putBookmark(const Bookmark &bookmark)
+{
+    m_putBookmark.bindValue(0, bookmark.id());
+    m_putBookmark.bindValue(1, bookmark.title());
+    m_putBookmark.bindValue(2, bookmark.url());
+    m_putBookmark.bindValue(3, bookmark.folder());
+    m_putBookmark.bindValue(4, bookmark.dateAdded().isValid()
+                                   ? QVariant(bookmark.dateAdded().toMSecsSinceEpoch()) : QVariant());
+    m_putBookmark.bindValue(5, bookmark.parentId());
+    if (!m_putBookmark.exec()) {
+        qWarning() << "写入书签失败:" << m_putBookmark.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SqliteStore::putBookmarks(const QList<Bookmark> &bookmarks)
+{
+    beginBatch();
+    bool ok = true;
+    for (const auto &bookmark : bookmarks) {
+        ok = putBookmark(bookmark) && ok;
+    }
+    return commitBatch() && ok;
+}
+
+bool SqliteStore::removeBookmark(const QString &id)
+{
+    m_removeBookmark.bindValue(0, id);
+    return m_removeBookmark.exec();
+}
+
+QList<BookmarkFolder> SqliteStore::loadBookmarkFolders()
+{
+    QList<BookmarkFolder> folders;
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    if (query.exec("SELECT id, title, parent_id, date_added FROM bookmark_folders ORDER BY seq")) {
+        while (query.next()) {
+            BookmarkFolder folder;
+            folder.setId(query.value(0).toString());
+            folder.setTitle(query.value(1).toString());
+            folder.setParentId(query.value(2).toString());
+            if (!query.value(3).isNull()) {
+                folder.setDateAdded(QDateTime::fromMSecsSinceEpoch(query.value(3).toLongLong()));
+            }
+            folders.append(folder);
+        }
+    }
+    return folders;
+}
+
+bool SqliteStore::replaceBookmarkFolders(const QList<BookmarkFolder> &folders)
+{
+    // 文件夹数量很少，整体替换即可；seq 顺序即父文件夹在前的保存顺序
+    beginBatch();
+    bool ok = exec("DELETE FROM bookmark_folders");
+
+    QSqlQuery insert(m_db);
+    ok = ok && prepare(insert, "INSERT INTO bookmark_folders (id, title, parent_id, date_added) "
+                               "VALUES (?, ?, ?, ?)");
+    for (const auto &folder : folders) {
+        if (!ok) {
+            break;
+        }
+        insert.bindValue(0, folder.id());
+        insert.bindValue(1, folder.title());
+        insert.bindValue(2, folder.parentId());
+        insert.bindValue(3, folder.dateAdded().isValid()
+                                ? QVariant(folder.dateAdded().toMSecsSinceEpoch()) : QVariant());
+        ok = insert.exec();
+    }
+    return commitBatch() && ok;
+}
+
+bool SqliteStore::exec(const QString &sql)
+{
+    QSqlQuery query(m_db);
+    if (!query.exec(sql)) {
+        qWarning() << "执行 SQL 失败:" << sql << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool SqliteStore::hasColumn(const QString &table, const QString &column)
+{
+    QSqlQuery query(m_db);
+    if (query.exec(QStringLiteral("PRAGMA table_info(%1)").arg(table))) {
+        while (query.next()) {
+            if (query.value(1).toString() == column) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool SqliteStore::prepare(QSqlQuery &query, const QString &sql)
+{
+    if (!query.prepare(sql)) {
+        qWarning() << "预编译 SQL 失败:" << sql << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QString SqliteStore::ftsPhrase(const QString &query)
+{
+    // 作为一个短语整体匹配，双引号需要转义
+    QString escaped = query;
+    escaped.replace('"', "\"\"");
+    return '"' + escaped + '"';
+}
+
+QString SqliteStore::likePattern(const QString &query)
+{
+    QString escaped = query;
+    escaped.replace('\\', "\\\\");
+    escaped.replace('%', "\\%");
+    escaped.replace('_', "\\_");
+    return '%' + escaped + '%';
+}
+
+HistoryItem SqliteStore::historyFromQuery(const QSqlQuery &query)
+{
+    HistoryItem item;
+    item.setId(query.value(0).toString());
+    item.setUrl(query.value(1).toString());
+    item.setTitle(query.value(2).toString());
+    if (!query.value(3).isNull()) {
+        item.setTimestamp(QDateTime::fromMSecsSinceEpoch(query.value(3).toLongLong()));
+    }
+    item.setVisitCount(query.value(4).toInt());
+    return item;
+}
+
+Bookmark SqliteStore::bookmarkFromQuery(const QSqlQuery &query)
+{
+    Bookmark bookmark;
+    bookmark.setId(query.value(0).toString());
+    bookmark.setTitle(query.value(1).toString());
+    bookmark.setUrl(query.value(2).toString());
+    bookmark.setFolder(query.value(3).toString());
+    if (!query.value(4).isNull()) {
+        bookmark.setDateAdded(QDateTime::fromMSecsSinceEpoch(query.value(4).toLongLong()));
+    }
+    bookmark.setParentId(query.value(5).toString());
+    return bookmark;
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,80 @@
+#ifndef SQLITESTORE_H
+#define SQLITESTORE_H
+
+#include <QString>
+#include <QList>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include "models/bookmark.h"
+#include "models/bookmarkfolder.h"
+#include "models/historyitem.h"
+
+namespace WinBrowserQt {
+
+// 基于 SQLite 的历史记录和书签存储（WAL 模式、预编译语句、批量事务）
+// 历史记录的标题和 URL 建有 FTS5 trigram 全文索引，支持任意子串搜索
+// 只能在打开它的线程中使用
+class SqliteStore
+{
+public:
+    SqliteStore();
+    ~SqliteStore();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const;
+
+    // 是否还没有从 JSON/二进制文件迁移过数据（记录在 PRAGMA user_version 中，
+    // 迁移后即使历史记录和书签都被清空也不会重复导入旧文件）
+    bool needsMigration();
+    bool markMigrated();
+    bool hasFullTextSearch() const { return m_hasFts; }
+
+    bool beginBatch();
+    bool commitBatch();
+
+    // since 有效时只加载该时间之后的记录
+    QList<HistoryItem> loadHistory(const QDateTime &since = QDateTime());
+    bool insertHistory(const HistoryItem &item);
+    bool insertHistory(const QList<HistoryItem> &history);
+    bool updateHistory(const HistoryItem &item);
+    bool removeHistory(const QString &id);
+    bool clearHistory();
+    QList<HistoryItem> searchHistory(const QString &query, int limit);
+
+    QList<Bookmark> loadBookmarks();
+    bool putBookmark(const Bookmark &bookmark);
+    bool putBookmarks(const QList<Bookmark> &bookmarks);
+    bool removeBookmark(const QString &id);
+
+    QList<BookmarkFolder> loadBookmarkFolders();
+    bool replaceBookmarkFolders(const QList<BookmarkFolder> &folders);
+
+private:
+    bool createSchema();
+    bool exec(const QString &sql);
+    bool hasColumn(const QString &table, const QString &column);
+    bool prepare(QSqlQuery &query, const QString &sql);
+    static bool execHistory(QSqlQuery &query, const HistoryItem &item);
+    static QString ftsPhrase(const QString &query);
+    static QString likePattern(const QString &query);
+    static HistoryItem historyFromQuery(const QSqlQuery &query);
+    static Bookmark bookmarkFromQuery(const QSqlQuery &query);
+
+    QString m_connectionName;
+    QSqlDatabase m_db;
+    bool m_hasFts;
+    int m_batchDepth;
+
+    QSqlQuery m_insertHistory;
+    QSqlQuery m_updateHistory;
+    QSqlQuery m_removeHistory;
+    QSqlQuery m_putBookmark;
+    QSqlQuery m_removeBookmark;
+
+    static const int MIGRATED_VERSION = 1;
+};
+
+} // namespace WinBrowserQt
+
+#endif // SQLITESTORE_H
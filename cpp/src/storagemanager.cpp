@@ -1,19 +1,41 @@
 
 #include "storagemanager.h"
+#include "binarystore.h"
 #include <QStandardPaths>
 #include <QDir>
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QSaveFile>
+#include <QSet>
 #include <QDebug>
+#include <algorithm>
 
 namespace WinBrowserQt {
 
 StorageManager::StorageManager(QObject *parent)
     : QObject(parent)
+    , m_writer(new StorageWriter(this))
 {
     initializeDataDirectory();
+    initializeSqliteBackend();
+
+    // 写入线程的信号跨线程排队转发
+    connect(m_writer, &StorageWriter::fileWritten, this, &StorageManager::dataSaved);
+    connect(m_writer, &StorageWriter::writeError, this, &StorageManager::saveError);
+    m_writer->start(QThread::LowPriority);
+}
+
+StorageManager::~StorageManager()
+{
+    // 写完剩余任务后停止写入线程，避免任务在对象销毁后继续访问成员
+    m_writer->stop(SHUTDOWN_FLUSH_TIMEOUT_MS);
+}
+
+void StorageManager::flush(int timeoutMs)
+{
+    m_writer->flush(timeoutMs);
 }
 
 void StorageManager::initializeDataDirectory()
@@ -26,8 +48,87 @@ void StorageManager::initializeDataDirectory()
     }
 
     m_settingsFile = m_dataDirectory + "/settings.json";
-    m_bookmarksFile = m_dataDirectory + "/bookmarks.json";
-    m_historyFile = m_dataDirectory + "/history.json";
+    m_bookmarksFile = m_dataDirectory + "/bookmarks.dat";
+    m_bookmarkFoldersFile = m_dataDirectory + "/bookmark-folders.dat";
+    m_historyFile = m_dataDirectory + "/history.dat";
+    m_legacyBookmarksFile = m_dataDirectory + "/bookmarks.json";
+    m_legacyHistoryFile = m_dataDirectory + "/history.json";
+    m_historyJournalFile = m_dataDirectory + "/history.journal";
+    m_historyCompactingFile = m_dataDirectory + "/history.journal.compacting";
+
+    m_bookmarksJournalFile = m_dataDirectory + "/bookmarks.journal";
+    m_bookmarksCompactingFile = m_dataDirectory + "/bookmarks.journal.compacting";
+
+    m_historyJournal.reset(new JournalFile(m_historyJournalFile));
+    m_bookmarksJournal.reset(new JournalFile(m_bookmarksJournalFile));
+
+    m_historyArchiveDirectory = m_dataDirectory + "/history-archive";
+    m_historyArchive.reset(new HistoryArchive(m_historyArchiveDirectory));
+    m_historyArchive->load();
+}
+
+void StorageManager::initializeSqliteBackend()
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    if (loadSettings().storageBackend() != "sqlite") {
+        return;
+    }
+
+    m_databaseFile = m_dataDirectory + "/browser.db";
+    m_sqliteStore.reset(new SqliteStore());
+    if (!m_sqliteStore->open(m_databaseFile)) {
+        qWarning() << "打开数据库失败，继续使用文件存储:" << m_databaseFile;
+        m_sqliteStore.reset();
+        return;
+    }
+
+    // 首次启用时把现有快照和增量日志导入数据库；原文件保留，切回文件后端时仍可使用
+    if (m_sqliteStore->needsMigration()) {
+        m_sqliteStore->beginBatch();
+        const bool migrated = m_sqliteStore->insertHistory(readAllHistoryFromFiles())
+            && m_sqliteStore->putBookmarks(readBookmarksFromFiles())
+            && m_sqliteStore->replaceBookmarkFolders(readBookmarkFoldersFromFiles())
+            && m_sqliteStore->markMigrated();
+        if (!m_sqliteStore->commitBatch() || !migrated) {
+            qWarning() << "迁移数据到 SQLite 失败，继续使用文件存储";
+            m_sqliteStore.reset();
+        }
+    }
+#endif
+}
+
+bool StorageManager::hasIndexedSearch() const
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    return !m_sqliteStore.isNull();
+#else
+    return false;
+#endif
+}
+
+QList<HistoryItem> StorageManager::searchHistory(const QString &query, int limit)
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        return m_sqliteStore->searchHistory(query, limit);
+    }
+#else
+    Q_UNUSED(query);
+    Q_UNUSED(limit);
+#endif
+    return QList<HistoryItem>();
+}
+
+QList<HistoryItem> StorageManager::searchArchivedHistory(const QString &query, const QDateTime &from,
+                                                         const QDateTime &to, int limit) const
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    // SQLite 后端没有冷归档，全部记录都在数据库中
+    if (m_sqliteStore) {
+        return QList<HistoryItem>();
+    }
+#endif
+    return m_historyArchive->search(query, from, to, limit);
 }
 
 Settings StorageManager::loadSettings()
@@ -44,12 +145,17 @@ Settings StorageManager::loadSettings()
                 Settings settings;
                 settings.setHomePage(obj["homePage"].toString("about:blank"));
                 settings.setSearchEngine(obj["searchEngine"].toString("bing"));
+                settings.setSearchSuggestUrl(obj["searchSuggestUrl"].toString(Settings().searchSuggestUrl()));
                 settings.setDownloadPath(obj["downloadPath"].toString(
                     QStandardPaths::writableLocation(QStandardPaths::DownloadLocation)));
                 settings.setShowBookmarksBar(obj["showBookmarksBar"].toBool(true));
                 settings.setBlockPopups(obj["blockPopups"].toBool(true));
                 settings.setEnableJavaScript(obj["enableJavaScript"].toBool(true));
                 settings.setTheme(obj["theme"].toString("system"));
+                settings.setStorageBackend(obj["storageBackend"].toString("file"));
+                settings.setBackForwardCapacity(obj["backForwardCapacity"].toInt(100));
+                m_savedSettingsHash = settings.contentHash();
+                m_hasSavedSettings = true;
                 return settings;
             }
         }
@@ -62,113 +168,362 @@ Settings StorageManager::loadSettings()
 
 void StorageManager::saveSettings(const Settings &settings)
 {
-    try {
-        QJsonObject obj;
-        obj["homePage"] = settings.homePage();
-        obj["searchEngine"] = settings.searchEngine();
-        obj["downloadPath"] = settings.downloadPath();
-        obj["showBookmarksBar"] = settings.showBookmarksBar();
-        obj["blockPopups"] = settings.blockPopups();
-        obj["enableJavaScript"] = settings.enableJavaScript();
-        obj["theme"] = settings.theme();
-
-        QJsonDocument doc(obj);
-        QFile file(m_settingsFile);
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write(doc.toJson(QJsonDocument::Indented));
-            file.close();
+    // 同步保存同样经过写入线程，保证与异步保存之间的顺序
+    saveSettingsAsync(settings);
+    m_writer->flush(SHUTDOWN_FLUSH_TIMEOUT_MS);
+}
+
+QList<Bookmark> StorageManager::loadBookmarks()
+{
+    QList<Bookmark> bookmarks;
+    bool generatedDefaults = false;
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        bookmarks = m_sqliteStore->loadBookmarks();
+    } else
+#endif
+    {
+        if (!QFile::exists(m_bookmarksFile) && QFile::exists(m_legacyBookmarksFile)) {
+            // 旧版本的 JSON 书签文件：迁移为二进制格式
+            m_writer->schedule(m_bookmarksFile, [this]() {
+                QList<Bookmark> snapshot;
+                readBookmarksSnapshot(&snapshot);
+                return BinaryStore::serializeBookmarks(snapshot);
+            }, BOOKMARKS_DEBOUNCE_MS);
         }
-    } catch (const std::exception &e) {
-        qWarning() << "保存设置失败:" << e.what();
+        bookmarks = readBookmarksFromFiles(&generatedDefaults);
     }
+
+    // 记录已持久化的内容哈希，之后的保存只写出有变化的记录；
+    // 生成的默认书签尚未持久化，不记录哈希，首次保存时作为新增记录写入日志；
+    // 常驻内存的书签通过字符串池共享重复的文件夹名和 URL
+    m_savedBookmarkHashes.clear();
+    m_savedBookmarkHashes.reserve(bookmarks.size());
+    for (auto &bookmark : bookmarks) {
+        bookmark.internStrings();
+        if (!generatedDefaults) {
+            m_savedBookmarkHashes.insert(bookmark.id(), bookmark.contentHash());
+        }
+    }
+    m_savedBookmarks = PersistentList<Bookmark>::Snapshot();
+
+    return bookmarks;
 }
 
-QList<Bookmark> StorageManager::loadBookmarks()
+QList<Bookmark> StorageManager::readBookmarksFromFiles(bool *generatedDefaults)
 {
+    QList<Bookmark> bookmarks;
+    bool defaults = false;
     try {
-        QFile file(m_bookmarksFile);
-        if (file.exists() && file.open(QIODevice::ReadOnly)) {
-            QByteArray data = file.readAll();
-            file.close();
-
-            QJsonDocument doc = QJsonDocument::fromJson(data);
-            if (doc.isArray()) {
-                QList<Bookmark> bookmarks;
-                QJsonArray array = doc.array();
-                for (const auto &value : array) {
-                    if (value.isObject()) {
-                        QJsonObject obj = value.toObject();
-                        Bookmark bookmark;
-                        bookmark.setId(obj["id"].toString());
-                        bookmark.setTitle(obj["title"].toString());
-                        bookmark.setUrl(obj["url"].toString());
-                        bookmark.setFolder(obj["folder"].toString());
-                        bookmark.setDateAdded(QDateTime::fromString(obj["dateAdded"].toString(), Qt::ISODate));
-                        bookmarks.append(bookmark);
-                    }
-                }
-                return bookmarks;
-            }
+        if (!readBookmarksSnapshot(&bookmarks)
+            && !QFile::exists(m_bookmarksJournalFile) && !QFile::exists(m_bookmarksCompactingFile)) {
+            // 全新的配置：默认书签在首次保存时作为新增记录写入日志
+            bookmarks = getDefaultBookmarks();
+            defaults = true;
         }
+
+        applyBookmarksJournal(bookmarks, JournalFile::replay(m_bookmarksCompactingFile));
+        applyBookmarksJournal(bookmarks, JournalFile::replay(m_bookmarksJournalFile));
     } catch (const std::exception &e) {
         qWarning() << "加载书签失败:" << e.what();
+        bookmarks = getDefaultBookmarks();
+        defaults = true;
+    }
+    if (generatedDefaults) {
+        *generatedDefaults = defaults;
     }
+    return bookmarks;
+}
 
-    return getDefaultBookmarks();
+QList<BookmarkFolder> StorageManager::loadBookmarkFolders()
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        return m_sqliteStore->loadBookmarkFolders();
+    }
+#endif
+    return readBookmarkFoldersFromFiles();
 }
 
-void StorageManager::saveBookmarks(const QList<Bookmark> &bookmarks)
+QList<BookmarkFolder> StorageManager::readBookmarkFoldersFromFiles() const
 {
-    try {
-        QJsonArray array;
-        for (const auto &bookmark : bookmarks) {
-            QJsonObject obj;
-            obj["id"] = bookmark.id();
-            obj["title"] = bookmark.title();
-            obj["url"] = bookmark.url();
-            obj["folder"] = bookmark.folder();
-            obj["dateAdded"] = bookmark.dateAdded().toString(Qt::ISODate);
-            array.append(obj);
+    MappedBookmarkFolderFile file;
+    return file.open(m_bookmarkFoldersFile) ? file.items() : QList<BookmarkFolder>();
+}
+
+void StorageManager::saveBookmarkFoldersAsync(const QList<BookmarkFolder> &folders)
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        if (!m_sqliteStore->replaceBookmarkFolders(folders)) {
+            emit saveError("保存书签文件夹失败");
         }
+        return;
+    }
+#endif
+    m_writer->schedule(m_bookmarkFoldersFile, [folders]() {
+        return BinaryStore::serializeBookmarkFolders(folders);
+    }, BOOKMARKS_DEBOUNCE_MS);
+}
 
-        QJsonDocument doc(array);
-        QFile file(m_bookmarksFile);
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write(doc.toJson(QJsonDocument::Indented));
-            file.close();
+bool StorageManager::readBookmarksSnapshot(QList<Bookmark> *bookmarks) const
+{
+    MappedBookmarkFile file;
+    if (file.open(m_bookmarksFile)) {
+        *bookmarks = file.items();
+        return true;
+    }
+
+    // 尚未迁移的旧 JSON 快照
+    return readBookmarksJson(m_legacyBookmarksFile, bookmarks);
+}
+
+void StorageManager::saveBookmarks(const PersistentList<Bookmark>::Snapshot &bookmarks)
+{
+    saveBookmarksAsync(bookmarks);
+}
+
+bool StorageManager::exportToJson(const QString &directory)
+{
+    QDir dir(directory);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        return false;
+    }
+
+    return writeBookmarksJson(dir.filePath("bookmarks.json"), loadBookmarks())
+        && writeBookmarkFoldersJson(dir.filePath("bookmark-folders.json"), loadBookmarkFolders())
+        && writeHistoryJson(dir.filePath("history.json"), loadAllHistory());
+}
+
+bool StorageManager::importFromJson(const QString &directory)
+{
+    // 先写完排队的任务（包括启动时安排的压缩），否则它们会与导入的快照互相替换
+    m_writer->flush(SHUTDOWN_FLUSH_TIMEOUT_MS);
+
+    QDir dir(directory);
+    bool imported = false;
+
+    QList<Bookmark> bookmarks;
+    if (readBookmarksJson(dir.filePath("bookmarks.json"), &bookmarks)) {
+        saveBookmarksAsync(PersistentList<Bookmark>(bookmarks).snapshot());
+        imported = true;
+    }
+
+    // 旧版本导出的目录没有文件夹文件，加载时会按书签的 folder 字段重建
+    QList<BookmarkFolder> folders;
+    if (readBookmarkFoldersJson(dir.filePath("bookmark-folders.json"), &folders)) {
+        saveBookmarkFoldersAsync(folders);
+        imported = true;
+    }
+
+    // 导入的历史记录替换快照，之前的增量日志随快照提交一并删除
+    QList<HistoryItem> history;
+    if (readHistoryJson(dir.filePath("history.json"), &history)) {
+        replaceHistoryAsync(PersistentList<HistoryItem>(history).snapshot());
+        imported = true;
+    }
+
+    return imported && m_writer->flush(SHUTDOWN_FLUSH_TIMEOUT_MS);
+}
+
+bool StorageManager::readBookmarksJson(const QString &path, QList<Bookmark> *bookmarks) const
+{
+    QFile file(path);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+    file.close();
+
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (!doc.isArray()) {
+        return false;
+    }
+
+    QJsonArray array = doc.array();
+    bookmarks->clear();
+    bookmarks->reserve(array.size());
+    for (const auto &value : array) {
+        if (value.isObject()) {
+            bookmarks->append(bookmarkFromJson(value.toObject()));
         }
-    } catch (const std::exception &e) {
-        qWarning() << "保存书签失败:" << e.what();
     }
+    return true;
+}
+
+bool StorageManager::readBookmarkFoldersJson(const QString &path, QList<BookmarkFolder> *folders) const
+{
+    QFile file(path);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isArray()) {
+        return false;
+    }
+
+    const QJsonArray array = doc.array();
+    folders->clear();
+    folders->reserve(array.size());
+    for (const auto &value : array) {
+        if (value.isObject()) {
+            folders->append(bookmarkFolderFromJson(value.toObject()));
+        }
+    }
+    return true;
+}
+
+bool StorageManager::writeBookmarkFoldersJson(const QString &path, const QList<BookmarkFolder> &folders) const
+{
+    QJsonArray array;
+    for (const auto &folder : folders) {
+        array.append(bookmarkFolderToJson(folder));
+    }
+
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(array).toJson(QJsonDocument::Indented));
+        return file.commit();
+    }
+    return false;
+}
+
+bool StorageManager::writeBookmarksJson(const QString &path, const QList<Bookmark> &bookmarks) const
+{
+    QJsonArray array;
+    for (const auto &bookmark : bookmarks) {
+        array.append(bookmarkToJson(bookmark));
+    }
+
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(array).toJson(QJsonDocument::Indented));
+        return file.commit();
+    }
+    return false;
+}
+
+bool StorageManager::readHistoryJson(const QString &path, QList<HistoryItem> *history) const
+{
+    QFile file(path);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+    file.close();
+
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (!doc.isArray()) {
+        return false;
+    }
+
+    QJsonArray array = doc.array();
+    history->clear();
+    history->reserve(array.size());
+    for (const auto &value : array) {
+        if (value.isObject()) {
+            history->append(historyItemFromJson(value.toObject()));
+        }
+    }
+    return true;
+}
+
+bool StorageManager::writeHistoryJson(const QString &path, const QList<HistoryItem> &history) const
+{
+    QJsonArray array;
+    for (const auto &item : history) {
+        array.append(historyItemToJson(item));
+    }
+
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(array).toJson(QJsonDocument::Indented));
+        return file.commit();
+    }
+    return false;
 }
 
 QList<HistoryItem> StorageManager::loadHistory()
 {
-    try {
-        QFile file(m_historyFile);
-        if (file.exists() && file.open(QIODevice::ReadOnly)) {
-            QByteArray data = file.readAll();
-            file.close();
+    const QDateTime cutoff = QDateTime::currentDateTime().addDays(-HISTORY_HOT_DAYS);
 
-            QJsonDocument doc = QJsonDocument::fromJson(data);
-            if (doc.isArray()) {
-                QList<HistoryItem> history;
-                QJsonArray array = doc.array();
-                for (const auto &value : array) {
-                    if (value.isObject()) {
-                        QJsonObject obj = value.toObject();
-                        HistoryItem item;
-                        item.setId(obj["id"].toString());
-                        item.setUrl(obj["url"].toString());
-                        item.setTitle(obj["title"].toString());
-                        item.setTimestamp(QDateTime::fromString(obj["timestamp"].toString(), Qt::ISODate));
-                        item.setVisitCount(obj["visitCount"].toInt(1));
-                        history.append(item);
-                    }
-                }
-                return history;
-            }
+    QList<HistoryItem> history;
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        history = m_sqliteStore->loadHistory(cutoff);
+        internHistoryStrings(history);
+        return history;
+    }
+#endif
+
+    history = readHistoryFromFiles();
+    if (std::any_of(history.cbegin(), history.cend(),
+                    [&cutoff](const HistoryItem &item) { return isColdHistory(item, cutoff); })) {
+        // 快照中有超出热窗口的记录：压缩时移入冷归档（旧 JSON 快照也在这一步迁移），
+        // 界面只保留热窗口内的记录
+        compactHistoryAsync();
+        history.removeIf([&cutoff](const HistoryItem &item) { return isColdHistory(item, cutoff); });
+    } else if (!QFile::exists(m_historyFile) && QFile::exists(m_legacyHistoryFile)) {
+        // 首次启动新版本时把旧的 JSON 快照迁移为二进制格式
+        m_writer->schedule(m_historyFile, [this]() {
+            return BinaryStore::serializeHistory(readHistorySnapshot());
+        }, HISTORY_DEBOUNCE_MS);
+    }
+    internHistoryStrings(history);
+    return history;
+}
+
+void StorageManager::internHistoryStrings(QList<HistoryItem> &history)
+{
+    // 只驻留热窗口内的记录；冷归档和导出路径读出的记录用完即释放，不进字符串池
+    for (auto &item : history) {
+        item.internStrings();
+    }
+}
+
+QList<HistoryItem> StorageManager::loadAllHistory()
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        return m_sqliteStore->loadHistory();
+    }
+#endif
+    return readAllHistoryFromFiles();
+}
+
+QList<HistoryItem> StorageManager::readAllHistoryFromFiles()
+{
+    QList<HistoryItem> history = m_historyArchive->items();
+    QSet<QString> archived;
+    archived.reserve(history.size());
+    for (const auto &item : std::as_const(history)) {
+        archived.insert(item.id());
+    }
+    for (const auto &item : readHistoryFromFiles()) {
+        if (!archived.contains(item.id())) {
+            history.append(item);
         }
+    }
+    return history;
+}
+
+bool StorageManager::isColdHistory(const HistoryItem &item, const QDateTime &cutoff)
+{
+    // 没有时间戳的记录无法归入时间段，始终留在热窗口
+    return item.timestamp().isValid() && item.timestamp() < cutoff;
+}
+
+QList<HistoryItem> StorageManager::readHistoryFromFiles()
+{
+    try {
+        // 快照 + 未压缩完成的归档日志 + 当前日志，按顺序重放
+        QList<HistoryItem> history = readHistorySnapshot();
+        applyHistoryJournal(history, JournalFile::replay(m_historyCompactingFile));
+        applyHistoryJournal(history, JournalFile::replay(m_historyJournalFile));
+        return history;
     } catch (const std::exception &e) {
         qWarning() << "加载历史记录失败:" << e.what();
     }
@@ -176,124 +531,461 @@ QList<HistoryItem> StorageManager::loadHistory()
     return QList<HistoryItem>();
 }
 
-void StorageManager::saveHistory(const QList<HistoryItem> &history)
+void StorageManager::saveHistory(const PersistentList<HistoryItem>::Snapshot &history)
 {
-    try {
-        QJsonArray array;
-        for (const auto &item : history) {
-            QJsonObject obj;
-            obj["id"] = item.id();
-            obj["url"] = item.url();
-            obj["title"] = item.title();
-            obj["timestamp"] = item.timestamp().toString(Qt::ISODate);
-            obj["visitCount"] = item.visitCount();
-            array.append(obj);
+    m_writer->flush(SHUTDOWN_FLUSH_TIMEOUT_MS);
+    replaceHistoryAsync(history);
+    m_writer->flush(SHUTDOWN_FLUSH_TIMEOUT_MS);
+}
+
+void StorageManager::applyHistoryChanges(const HistoryChangeBatch &batch)
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        m_sqliteStore->beginBatch();
+        bool ok = !batch.isCleared() || m_sqliteStore->clearHistory();
+        for (const auto &change : batch.changes()) {
+            switch (change.type) {
+            case HistoryChangeType::Added:
+                ok = m_sqliteStore->insertHistory(change.item) && ok;
+                break;
+            case HistoryChangeType::Updated:
+                ok = m_sqliteStore->updateHistory(change.item) && ok;
+                break;
+            case HistoryChangeType::Removed:
+                ok = m_sqliteStore->removeHistory(change.item.id()) && ok;
+                break;
+            case HistoryChangeType::Cleared:
+                break;
+            }
+        }
+        if (!m_sqliteStore->commitBatch() || !ok) {
+            emit saveError("写入历史记录失败");
         }
+        return;
+    }
+#endif
 
-        QJsonDocument doc(array);
-        QFile file(m_historyFile);
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write(doc.toJson(QJsonDocument::Indented));
-            file.close();
+    QList<QJsonObject> records;
+    records.reserve(batch.changes().size() + 1);
+    if (batch.isCleared()) {
+        QJsonObject record;
+        record["op"] = "clear";
+        records.append(record);
+    }
+    for (const auto &change : batch.changes()) {
+        QJsonObject record;
+        switch (change.type) {
+        case HistoryChangeType::Added:
+            record = historyItemToJson(change.item);
+            record["op"] = "add";
+            break;
+        case HistoryChangeType::Updated:
+            record = historyItemToJson(change.item);
+            record["op"] = "update";
+            break;
+        case HistoryChangeType::Removed:
+            record["op"] = "remove";
+            record["id"] = change.item.id();
+            break;
+        case HistoryChangeType::Cleared:
+            continue;
         }
-    } catch (const std::exception &e) {
-        qWarning() << "保存历史记录失败:" << e.what();
+        records.append(record);
+    }
+
+    if (!m_historyJournal->append(records)) {
+        emit saveError("写入历史记录日志失败");
+        return;
+    }
+    if (batch.isCleared()) {
+        m_historyArchive->clear();
+    }
+    if (m_historyJournal->recordCount() >= HISTORY_COMPACT_THRESHOLD) {
+        compactHistoryAsync();
     }
 }
 
-void StorageManager::saveAllData()
+void StorageManager::compactHistoryAsync()
 {
-    // 保存所有数据的方法，由主程序调用
-}
+    // 上一次压缩未完成（例如进程崩溃）时保留旧归档，本次先把它合并进快照
+    if (!QFile::exists(m_historyCompactingFile)) {
+        m_historyJournal->rotate(m_historyCompactingFile);
+    }
+
+    // 快照原子替换成功后才删除归档；中途崩溃时重放是幂等的
+    const int generation = m_historyArchive->generation();
+    m_writer->schedule(m_historyFile, [this, generation]() {
+        QList<HistoryItem> history = readHistorySnapshot();
+        applyHistoryJournal(history, JournalFile::replay(m_historyCompactingFile));
 
-QFuture<void> StorageManager::saveSettingsAsync(const Settings &settings)
-{
-    return QtConcurrent::run([this, settings]() {
-        try {
-            QJsonObject obj;
-            obj["homePage"] = settings.homePage();
-            obj["searchEngine"] = settings.searchEngine();
-            obj["downloadPath"] = settings.downloadPath();
-            obj["showBookmarksBar"] = settings.showBookmarksBar();
-            obj["blockPopups"] = settings.blockPopups();
-            obj["enableJavaScript"] = settings.enableJavaScript();
-            obj["theme"] = settings.theme();
-
-            QJsonDocument doc(obj);
-            QFile file(m_settingsFile);
-            if (file.open(QIODevice::WriteOnly)) {
-                file.write(doc.toJson(QJsonDocument::Indented));
-                file.close();
-                QMetaObject::invokeMethod(this, "dataSaved", Qt::QueuedConnection);
+        // 超出热窗口的记录写成新的冷段后才从快照中移除；段写入失败时留到下次压缩。
+        // 段写入后、快照提交前崩溃会让记录同时出现在两处，查询时按 id 去重
+        const QDateTime cutoff = QDateTime::currentDateTime().addDays(-HISTORY_HOT_DAYS);
+        QList<HistoryItem> cold;
+        for (const auto &item : std::as_const(history)) {
+            if (isColdHistory(item, cutoff)) {
+                cold.append(item);
             }
-        } catch (const std::exception &e) {
-            QMetaObject::invokeMethod(this, [this, msg = QString::fromUtf8(e.what())]() {
-                emit saveError(msg);
-            }, Qt::QueuedConnection);
         }
+        if (!cold.isEmpty() && m_historyArchive->writeSegment(cold, generation)) {
+            history.removeIf([&cutoff](const HistoryItem &item) { return isColdHistory(item, cutoff); });
+        }
+
+        return BinaryStore::serializeHistory(history);
+    }, HISTORY_DEBOUNCE_MS, [this]() {
+        QFile::remove(m_historyCompactingFile);
     });
 }
 
-QFuture<void> StorageManager::saveBookmarksAsync(const QList<Bookmark> &bookmarks)
+QList<HistoryItem> StorageManager::readHistorySnapshot() const
 {
-    return QtConcurrent::run([this, bookmarks]() {
-        try {
-            QJsonArray array;
-            for (const auto &bookmark : bookmarks) {
-                QJsonObject obj;
-                obj["id"] = bookmark.id();
-                obj["title"] = bookmark.title();
-                obj["url"] = bookmark.url();
-                obj["folder"] = bookmark.folder();
-                obj["dateAdded"] = bookmark.dateAdded().toString(Qt::ISODate);
-                array.append(obj);
+    MappedHistoryFile file;
+    if (file.open(m_historyFile)) {
+        return file.items();
+    }
+
+    // 尚未迁移的旧 JSON 快照
+    QList<HistoryItem> history;
+    readHistoryJson(m_legacyHistoryFile, &history);
+    return history;
+}
+
+void StorageManager::applyHistoryJournal(QList<HistoryItem> &history, const QList<QJsonObject> &records)
+{
+    if (records.isEmpty()) {
+        return;
+    }
+
+    QHash<QString, int> indexById;
+    for (int i = 0; i < history.size(); ++i) {
+        indexById.insert(history[i].id(), i);
+    }
+
+    for (const auto &record : records) {
+        const QString op = record["op"].toString();
+        if (op == "add" || op == "update") {
+            HistoryItem item = historyItemFromJson(record);
+            // 按 id 去重，重复重放同一段日志不会产生重复记录；update 覆盖已有记录
+            auto it = indexById.constFind(item.id());
+            if (it == indexById.constEnd()) {
+                indexById.insert(item.id(), history.size());
+                history.append(item);
+            } else if (op == "update") {
+                history[it.value()] = item;
             }
+        } else if (op == "remove") {
+            const QString id = record["id"].toString();
+            auto it = indexById.constFind(id);
+            if (it != indexById.constEnd()) {
+                history.removeAt(it.value());
+                // 删除后重建下标
+                indexById.clear();
+                for (int i = 0; i < history.size(); ++i) {
+                    indexById.insert(history[i].id(), i);
+                }
+            }
+        } else if (op == "clear") {
+            history.clear();
+            indexById.clear();
+        }
+    }
+}
+
+QJsonObject StorageManager::bookmarkToJson(const Bookmark &bookmark)
+{
+    QJsonObject obj;
+    obj["id"] = bookmark.id();
+    obj["title"] = bookmark.title();
+    obj["url"] = bookmark.url();
+    obj["folder"] = bookmark.folder();
+    obj["parentId"] = bookmark.parentId();
+    obj["dateAdded"] = bookmark.dateAdded().toString(Qt::ISODate);
+    return obj;
+}
+
+Bookmark StorageManager::bookmarkFromJson(const QJsonObject &obj)
+{
+    Bookmark bookmark;
+    bookmark.setId(obj["id"].toString());
+    bookmark.setTitle(obj["title"].toString());
+    bookmark.setUrl(obj["url"].toString());
+    bookmark.setFolder(obj["folder"].toString());
+    bookmark.setParentId(obj["parentId"].toString());
+    bookmark.setDateAdded(QDateTime::fromString(obj["dateAdded"].toString(), Qt::ISODate));
+    return bookmark;
+}
+
+QJsonObject StorageManager::bookmarkFolderToJson(const BookmarkFolder &folder)
+{
+    QJsonObject obj;
+    obj["id"] = folder.id();
+    obj["title"] = folder.title();
+    obj["parentId"] = folder.parentId();
+    obj["dateAdded"] = folder.dateAdded().toString(Qt::ISODate);
+    return obj;
+}
 
-            QJsonDocument doc(array);
-            QFile file(m_bookmarksFile);
-            if (file.open(QIODevice::WriteOnly)) {
-                file.write(doc.toJson(QJsonDocument::Indented));
-                file.close();
-                QMetaObject::invokeMethod(this, "dataSaved", Qt::QueuedConnection);
+BookmarkFolder StorageManager::bookmarkFolderFromJson(const QJsonObject &obj)
+{
+    BookmarkFolder folder;
+    folder.setId(obj["id"].toString());
+    folder.setTitle(obj["title"].toString());
+    folder.setParentId(obj["parentId"].toString());
+    folder.setDateAdded(QDateTime::fromString(obj["dateAdded"].toString(), Qt::ISODate));
+    return folder;
+}
+
+QJsonObject StorageManager::historyItemToJson(const HistoryItem &item)
+{
+    QJsonObject obj;
+    obj["id"] = item.id();
+    obj["url"] = item.url();
+    obj["title"] = item.title();
+    obj["timestamp"] = item.timestamp().toString(Qt::ISODate);
+    obj["visitCount"] = item.visitCount();
+    return obj;
+}
+
+HistoryItem StorageManager::historyItemFromJson(const QJsonObject &obj)
+{
+    HistoryItem item;
+    item.setId(obj["id"].toString());
+    item.setUrl(obj["url"].toString());
+    item.setTitle(obj["title"].toString());
+    item.setTimestamp(QDateTime::fromString(obj["timestamp"].toString(), Qt::ISODate));
+    item.setVisitCount(obj["visitCount"].toInt(1));
+    return item;
+}
+
+void StorageManager::saveAllData()
+{
+    // 保存所有数据的方法，由主程序调用
+}
+
+void StorageManager::saveSettingsAsync(const Settings &settings)
+{
+    // 内容未变化时不产生写入
+    const size_t hash = settings.contentHash();
+    if (m_hasSavedSettings && hash == m_savedSettingsHash) {
+        return;
+    }
+    m_savedSettingsHash = hash;
+    m_hasSavedSettings = true;
+
+    m_writer->schedule(m_settingsFile, [settings]() {
+        return QJsonDocument(settingsToJson(settings)).toJson(QJsonDocument::Indented);
+    }, SETTINGS_DEBOUNCE_MS);
+}
+
+void StorageManager::saveBookmarksAsync(const PersistentList<Bookmark>::Snapshot &bookmarks)
+{
+    // 与上次保存的是同一版本，直接跳过
+    if (bookmarks.isSameVersion(m_savedBookmarks)) {
+        return;
+    }
+
+#ifdef WINBROWSER_HAS_SQLITE
+    // 一次保存中的所有增量放在同一个事务里提交
+    if (m_sqliteStore) {
+        m_sqliteStore->beginBatch();
+    }
+#endif
+
+    // 只把内容哈希变化的记录作为增量写入日志；文件后端的增量收集起来一次写入、一次刷新
+    QList<QJsonObject> records;
+    int matched = 0;
+    for (int i = 0; i < bookmarks.size(); ++i) {
+        // 与上次保存的快照共享同一块的位置内容没有变化，整块跳过，不逐条比较哈希
+        if (i % PersistentList<Bookmark>::CHUNK_SIZE == 0 && bookmarks.sharesChunk(m_savedBookmarks, i)) {
+            const int end = qMin(i + PersistentList<Bookmark>::CHUNK_SIZE,
+                                 qMin(bookmarks.size(), m_savedBookmarks.size()));
+            matched += end - i;
+            i = end - 1;
+            continue;
+        }
+
+        const Bookmark &bookmark = bookmarks.at(i);
+        const size_t hash = bookmark.contentHash();
+        auto it = m_savedBookmarkHashes.find(bookmark.id());
+        if (it != m_savedBookmarkHashes.end()) {
+            ++matched;
+            if (it.value() == hash) {
+                continue;
+            }
+            it.value() = hash;
+        } else {
+            m_savedBookmarkHashes.insert(bookmark.id(), hash);
+        }
+
+        persistBookmark(bookmark, &records);
+    }
+
+    // 已保存的记录比当前匹配到的多，说明有书签被删除
+    if (matched < m_savedBookmarkHashes.size()) {
+        QSet<QString> current;
+        current.reserve(bookmarks.size());
+        for (const auto &bookmark : bookmarks) {
+            current.insert(bookmark.id());
+        }
+
+        for (auto it = m_savedBookmarkHashes.begin(); it != m_savedBookmarkHashes.end();) {
+            if (current.contains(it.key())) {
+                ++it;
+                continue;
             }
-        } catch (const std::exception &e) {
-            QMetaObject::invokeMethod(this, [this, msg = QString::fromUtf8(e.what())]() {
-                emit saveError(msg);
-            }, Qt::QueuedConnection);
+            persistBookmarkRemoval(it.key(), &records);
+            it = m_savedBookmarkHashes.erase(it);
         }
+    }
+
+    m_savedBookmarks = bookmarks;
+
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        if (!m_sqliteStore->commitBatch()) {
+            emit saveError("保存书签失败");
+        }
+        return;
+    }
+#endif
+
+    if (!m_bookmarksJournal->append(records)) {
+        emit saveError("写入书签日志失败");
+    }
+    if (m_bookmarksJournal->recordCount() >= BOOKMARKS_COMPACT_THRESHOLD) {
+        compactBookmarksAsync();
+    }
+}
+
+void StorageManager::persistBookmark(const Bookmark &bookmark, QList<QJsonObject> *records)
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        if (!m_sqliteStore->putBookmark(bookmark)) {
+            emit saveError("写入书签失败");
+        }
+        return;
+    }
+#endif
+
+    QJsonObject record = bookmarkToJson(bookmark);
+    record["op"] = "put";
+    records->append(record);
+}
+
+void StorageManager::persistBookmarkRemoval(const QString &id, QList<QJsonObject> *records)
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    if (m_sqliteStore) {
+        if (!m_sqliteStore->removeBookmark(id)) {
+            emit saveError("删除书签失败");
+        }
+        return;
+    }
+#endif
+
+    QJsonObject record;
+    record["op"] = "remove";
+    record["id"] = id;
+    records->append(record);
+}
+
+void StorageManager::compactBookmarksAsync()
+{
+    if (!QFile::exists(m_bookmarksCompactingFile)) {
+        m_bookmarksJournal->rotate(m_bookmarksCompactingFile);
+    }
+
+    m_writer->schedule(m_bookmarksFile, [this]() {
+        QList<Bookmark> bookmarks;
+        readBookmarksSnapshot(&bookmarks);
+        applyBookmarksJournal(bookmarks, JournalFile::replay(m_bookmarksCompactingFile));
+        return BinaryStore::serializeBookmarks(bookmarks);
+    }, BOOKMARKS_DEBOUNCE_MS, [this]() {
+        QFile::remove(m_bookmarksCompactingFile);
     });
 }
 
-QFuture<void> StorageManager::saveHistoryAsync(const QList<HistoryItem> &history)
+void StorageManager::applyBookmarksJournal(QList<Bookmark> &bookmarks, const QList<QJsonObject> &records)
 {
-    return QtConcurrent::run([this, history]() {
-        try {
-            QJsonArray array;
-            for (const auto &item : history) {
-                QJsonObject obj;
-                obj["id"] = item.id();
-                obj["url"] = item.url();
-                obj["title"] = item.title();
-                obj["timestamp"] = item.timestamp().toString(Qt::ISODate);
-                obj["visitCount"] = item.visitCount();
-                array.append(obj);
-            }
+    if (records.isEmpty()) {
+        return;
+    }
+
+    QHash<QString, int> indexById;
+    for (int i = 0; i < bookmarks.size(); ++i) {
+        indexById.insert(bookmarks[i].id(), i);
+    }
 
-            QJsonDocument doc(array);
-            QFile file(m_historyFile);
-            if (file.open(QIODevice::WriteOnly)) {
-                file.write(doc.toJson(QJsonDocument::Indented));
-                file.close();
-                QMetaObject::invokeMethod(this, "dataSaved", Qt::QueuedConnection);
+    for (const auto &record : records) {
+        const QString op = record["op"].toString();
+        if (op == "put") {
+            Bookmark bookmark = bookmarkFromJson(record);
+            auto it = indexById.constFind(bookmark.id());
+            if (it != indexById.constEnd()) {
+                bookmarks[it.value()] = bookmark;
+            } else {
+                indexById.insert(bookmark.id(), bookmarks.size());
+                bookmarks.append(bookmark);
+            }
+        } else if (op == "remove") {
+            const QString id = record["id"].toString();
+            auto it = indexById.constFind(id);
+            if (it != indexById.constEnd()) {
+                bookmarks.removeAt(it.value());
+                // 删除后重建下标，删除操作很少见
+                indexById.clear();
+                for (int i = 0; i < bookmarks.size(); ++i) {
+                    indexById.insert(bookmarks[i].id(), i);
+                }
             }
-        } catch (const std::exception &e) {
-            QMetaObject::invokeMethod(this, [this, msg = QString::fromUtf8(e.what())]() {
-                emit saveError(msg);
-            }, Qt::QueuedConnection);
         }
+    }
+}
+
+void StorageManager::replaceHistoryAsync(const PersistentList<HistoryItem>::Snapshot &history)
+{
+#ifdef WINBROWSER_HAS_SQLITE
+    // 整体替换：清空后在同一个事务中重新插入
+    if (m_sqliteStore) {
+        m_sqliteStore->beginBatch();
+        const bool saved = m_sqliteStore->clearHistory()
+            && m_sqliteStore->insertHistory(history.toList());
+        if (!m_sqliteStore->commitBatch() || !saved) {
+            emit saveError("保存历史记录失败");
+        }
+        return;
+    }
+#endif
+
+    // 新快照已包含之前的全部变化：当前日志移入归档日志，快照提交后删除，之后追加的记录写入新的日志，
+    // 重放在新快照之上；上一次压缩失败留下的归档日志同样过时，直接删除
+    QFile::remove(m_historyCompactingFile);
+    m_historyJournal->rotate(m_historyCompactingFile);
+    m_writer->schedule(m_historyFile, [history]() {
+        return BinaryStore::serializeHistory(history);
+    }, HISTORY_DEBOUNCE_MS, [this]() {
+        QFile::remove(m_historyCompactingFile);
     });
 }
 
+QJsonObject StorageManager::settingsToJson(const Settings &settings)
+{
+    QJsonObject obj;
+    obj["homePage"] = settings.homePage();
+    obj["searchEngine"] = settings.searchEngine();
+    obj["searchSuggestUrl"] = settings.searchSuggestUrl();
+    obj["downloadPath"] = settings.downloadPath();
+    obj["showBookmarksBar"] = settings.showBookmarksBar();
+    obj["blockPopups"] = settings.blockPopups();
+    obj["enableJavaScript"] = settings.enableJavaScript();
+    obj["theme"] = settings.theme();
+    obj["storageBackend"] = settings.storageBackend();
+    obj["backForwardCapacity"] = settings.backForwardCapacity();
+    return obj;
+}
+
 Settings StorageManager::getDefaultSettings() const
 {
     Settings settings;
@@ -304,6 +996,8 @@ Settings StorageManager::getDefaultSettings() const
     settings.setBlockPopups(true);
     settings.setEnableJavaScript(true);
     settings.setTheme("system");
+    settings.setStorageBackend("file");
+    settings.setBackForwardCapacity(100);
     return settings;
 }
 
@@ -4,11 +4,21 @@
 
 #include <QObject>
 #include <QList>
-#include <QFuture>
-#include <QtConcurrent>
+#include <QScopedPointer>
+#include <QHash>
+#include "journalfile.h"
+#include "storagewriter.h"
+#include "historyarchive.h"
+#include "historychanges.h"
 #include "models/settings.h"
 #include "models/bookmark.h"
+#include "models/bookmarkfolder.h"
 #include "models/historyitem.h"
+#include "models/persistentlist.h"
+
+#ifdef WINBROWSER_HAS_SQLITE
+#include "sqlitestore.h"
+#endif
 
 namespace WinBrowserQt {
 
@@ -18,23 +28,49 @@ class StorageManager : public QObject
 
 public:
     explicit StorageManager(QObject *parent = nullptr);
+    ~StorageManager();
 
     Settings loadSettings();
     void saveSettings(const Settings &settings);
 
     QList<Bookmark> loadBookmarks();
-    void saveBookmarks(const QList<Bookmark> &bookmarks);
+    void saveBookmarks(const PersistentList<Bookmark>::Snapshot &bookmarks);
+    void compactBookmarksAsync();
+
+    // 书签文件夹树的结构；文件夹数量少、改动不频繁，整体保存
+    QList<BookmarkFolder> loadBookmarkFolders();
+    void saveBookmarkFoldersAsync(const QList<BookmarkFolder> &folders);
 
+    // 只返回热窗口（最近 HISTORY_HOT_DAYS 天）内的历史记录，更早的记录在压缩时移入冷归档
     QList<HistoryItem> loadHistory();
-    void saveHistory(const QList<HistoryItem> &history);
+    void saveHistory(const PersistentList<HistoryItem>::Snapshot &history);
+
+    // 历史记录增量：一批合并后的变化，文件后端一次写入日志，SQLite 后端在一个事务中写入；
+    // 更新记录整条替换（访问次数、时间、标题），重放时按 id 覆盖，保持幂等
+    void applyHistoryChanges(const HistoryChangeBatch &batch);
+    void compactHistoryAsync();
 
     void saveAllData();
+
+    // 与旧版本 JSON 格式之间的导入导出，用于迁移
+    bool exportToJson(const QString &directory);
+    bool importFromJson(const QString &directory);
     
-    // 异步保存方法
-    QFuture<void> saveSettingsAsync(const Settings &settings);
-    QFuture<void> saveBookmarksAsync(const QList<Bookmark> &bookmarks);
-    QFuture<void> saveHistoryAsync(const QList<HistoryItem> &history);
-    
+    // 异步保存方法：交给写入线程合并、防抖后按顺序写出
+    void saveSettingsAsync(const Settings &settings);
+    // 快照是 O(1) 的结构共享视图，写入线程在后台读取时界面线程可以继续修改列表
+    void saveBookmarksAsync(const PersistentList<Bookmark>::Snapshot &bookmarks);
+
+    // 在限定时间内写出所有待写数据，用于退出前
+    void flush(int timeoutMs);
+
+    // SQLite 后端启用时由全文索引回答历史记录搜索，覆盖全部已持久化的记录
+    bool hasIndexedSearch() const;
+    QList<HistoryItem> searchHistory(const QString &query, int limit);
+    // 查询冷归档中的历史记录（文件后端），from/to 无效时不限时间；归档自带锁，可以在后台线程调用
+    QList<HistoryItem> searchArchivedHistory(const QString &query, const QDateTime &from,
+                                             const QDateTime &to, int limit) const;
+
 signals:
     void dataSaved();
     void saveError(const QString &message);
@@ -43,9 +79,73 @@ private:
     QString m_dataDirectory;
     QString m_settingsFile;
     QString m_bookmarksFile;
+    QString m_bookmarkFoldersFile;
     QString m_historyFile;
+    QString m_legacyBookmarksFile;
+    QString m_legacyHistoryFile;
+    QString m_historyJournalFile;
+    QString m_historyCompactingFile;
+    QString m_bookmarksJournalFile;
+    QString m_bookmarksCompactingFile;
+    QString m_historyArchiveDirectory;
+
+    QScopedPointer<JournalFile> m_historyJournal;
+    QScopedPointer<JournalFile> m_bookmarksJournal;
+    QScopedPointer<HistoryArchive> m_historyArchive;
+    StorageWriter *m_writer;
+
+#ifdef WINBROWSER_HAS_SQLITE
+    // 设置中 storageBackend 为 "sqlite" 时才打开，否则为空
+    QScopedPointer<SqliteStore> m_sqliteStore;
+    QString m_databaseFile;
+#endif
+
+    // 脏记录跟踪：上次持久化的版本和每条记录的内容哈希
+    PersistentList<Bookmark>::Snapshot m_savedBookmarks;
+    QHash<QString, size_t> m_savedBookmarkHashes;
+    size_t m_savedSettingsHash = 0;
+    bool m_hasSavedSettings = false;
+
+    static const int HISTORY_COMPACT_THRESHOLD = 1000;
+    static const int BOOKMARKS_COMPACT_THRESHOLD = 500;
+    static const int SETTINGS_DEBOUNCE_MS = 500;
+    static const int BOOKMARKS_DEBOUNCE_MS = 1000;
+    static const int HISTORY_DEBOUNCE_MS = 2000;
+    static const int SHUTDOWN_FLUSH_TIMEOUT_MS = 3000;
+    static const int HISTORY_HOT_DAYS = 30;
 
     void initializeDataDirectory();
+    void initializeSqliteBackend();
+    QList<Bookmark> readBookmarksFromFiles(bool *generatedDefaults = nullptr);
+    QList<BookmarkFolder> readBookmarkFoldersFromFiles() const;
+    QList<HistoryItem> readHistoryFromFiles();
+    QList<HistoryItem> loadAllHistory();
+    QList<HistoryItem> readAllHistoryFromFiles();
+    static bool isColdHistory(const HistoryItem &item, const QDateTime &cutoff);
+    static void internHistoryStrings(QList<HistoryItem> &history);
+    // SQLite 后端直接写入当前事务，文件后端把日志记录追加到 records
+    void persistBookmark(const Bookmark &bookmark, QList<QJsonObject> *records);
+    void persistBookmarkRemoval(const QString &id, QList<QJsonObject> *records);
+    // 整体替换历史记录快照，之前的增量日志随新快照提交一并删除。调用方之后必须立即 flush：
+    // 同一文件的待写任务只保留最新一份，排队期间安排的压缩会用旧快照覆盖这次写入
+    void replaceHistoryAsync(const PersistentList<HistoryItem>::Snapshot &history);
+    bool readBookmarksSnapshot(QList<Bookmark> *bookmarks) const;
+    QList<HistoryItem> readHistorySnapshot() const;
+    bool readBookmarksJson(const QString &path, QList<Bookmark> *bookmarks) const;
+    bool writeBookmarksJson(const QString &path, const QList<Bookmark> &bookmarks) const;
+    bool readBookmarkFoldersJson(const QString &path, QList<BookmarkFolder> *folders) const;
+    bool writeBookmarkFoldersJson(const QString &path, const QList<BookmarkFolder> &folders) const;
+    bool readHistoryJson(const QString &path, QList<HistoryItem> *history) const;
+    bool writeHistoryJson(const QString &path, const QList<HistoryItem> &history) const;
+    static void applyBookmarksJournal(QList<Bookmark> &bookmarks, const QList<QJsonObject> &records);
+    static void applyHistoryJournal(QList<HistoryItem> &history, const QList<QJsonObject> &records);
+    static QJsonObject settingsToJson(const Settings &settings);
+    static QJsonObject bookmarkToJson(const Bookmark &bookmark);
+    static Bookmark bookmarkFromJson(const QJsonObject &obj);
+    static QJsonObject bookmarkFolderToJson(const BookmarkFolder &folder);
+    static BookmarkFolder bookmarkFolderFromJson(const QJsonObject &obj);
+    static QJsonObject historyItemToJson(const HistoryItem &item);
+    static HistoryItem historyItemFromJson(const QJsonObject &obj);
     Settings getDefaultSettings() const;
     QList<Bookmark> getDefaultBookmarks() const;
 };
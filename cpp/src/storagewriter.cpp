@@ -0,0 +1,161 @@
+#include "storagewriter.h"
+#include <QSaveFile>
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QList>
+#include <QPair>
+#include <QDebug>
+#include <limits>
+
+namespace WinBrowserQt {
+
+StorageWriter::StorageWriter(QObject *parent)
+    : QThread(parent)
+    , m_busy(false)
+    , m_flushing(false)
+    , m_stopping(false)
+{
+    m_clock.start();
+}
+
+StorageWriter::~StorageWriter()
+{
+    if (isRunning()) {
+        stop(0);
+    }
+}
+
+void StorageWriter::schedule(const QString &path, Serializer serializer, int debounceMs,
+                             CommitCallback onCommitted)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stopping) {
+        qWarning() << "存储写入线程已停止，忽略写入:" << path;
+        return;
+    }
+
+    const qint64 now = m_clock.elapsed();
+    auto it = m_pending.constFind(path);
+    const qint64 firstScheduledAt = it != m_pending.constEnd() ? it->firstScheduledAt : now;
+
+    Job job;
+    job.serializer = std::move(serializer);
+    job.onCommitted = std::move(onCommitted);
+    job.firstScheduledAt = firstScheduledAt;
+    job.dueAt = qMin(now + debounceMs, firstScheduledAt + MAX_DELAY_MS);
+
+    // 同一文件只保留最新的内容
+    m_pending.insert(path, job);
+    m_wakeup.wakeAll();
+}
+
+bool StorageWriter::flush(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs);
+    QMutexLocker locker(&m_mutex);
+
+    m_flushing = true;
+    m_wakeup.wakeAll();
+
+    while (!m_pending.isEmpty() || m_busy) {
+        if (!m_idle.wait(&m_mutex, deadline)) {
+            qWarning() << "存储写入超时，丢弃" << m_pending.size() << "个待写任务";
+            m_pending.clear();
+            m_flushing = false;
+            return false;
+        }
+    }
+
+    m_flushing = false;
+    return true;
+}
+
+void StorageWriter::stop(int timeoutMs)
+{
+    flush(timeoutMs);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wakeup.wakeAll();
+    }
+
+    // 正在提交的文件必须写完，QSaveFile 不支持中途取消
+    wait();
+}
+
+void StorageWriter::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (true) {
+        if (m_pending.isEmpty()) {
+            m_idle.wakeAll();
+            if (m_stopping) {
+                break;
+            }
+            m_wakeup.wait(&m_mutex);
+            continue;
+        }
+
+        const qint64 now = m_clock.elapsed();
+        qint64 nextDue = std::numeric_limits<qint64>::max();
+        for (const auto &job : std::as_const(m_pending)) {
+            nextDue = qMin(nextDue, job.dueAt);
+        }
+
+        if (!m_flushing && !m_stopping && nextDue > now) {
+            m_wakeup.wait(&m_mutex, QDeadlineTimer(nextDue - now));
+            continue;
+        }
+
+        // 成组提交：把所有已到期的任务一次取出写完
+        QList<QPair<QString, Job>> batch;
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            if (m_flushing || m_stopping || it->dueAt <= now) {
+                batch.append(qMakePair(it.key(), it.value()));
+                it = m_pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        m_busy = true;
+        locker.unlock();
+
+        for (const auto &entry : std::as_const(batch)) {
+            commit(entry.first, entry.second);
+        }
+
+        locker.relock();
+        m_busy = false;
+    }
+}
+
+void StorageWriter::commit(const QString &path, const Job &job)
+{
+    try {
+        // 序列化器返回空 QByteArray 表示没有需要写入的内容
+        const QByteArray data = job.serializer();
+        if (data.isNull()) {
+            return;
+        }
+
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)
+            || file.write(data) != data.size()
+            || !file.commit()) {
+            emit writeError(QString("写入文件失败: %1 (%2)").arg(path, file.errorString()));
+            return;
+        }
+
+        if (job.onCommitted) {
+            job.onCommitted();
+        }
+        emit fileWritten(path);
+    } catch (const std::exception &e) {
+        emit writeError(QString::fromUtf8(e.what()));
+    }
+}
+
+} // namespace WinBrowserQt
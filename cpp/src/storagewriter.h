@@ -0,0 +1,69 @@
+#ifndef STORAGEWRITER_H
+#define STORAGEWRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QByteArray>
+#include <functional>
+
+namespace WinBrowserQt {
+
+// 唯一的存储写入线程
+// 同一文件的待写任务只保留最新一份；任务在防抖窗口到期后成批序列化，
+// 并通过 QSaveFile 原子改名提交，保证写入顺序和文件完整性
+class StorageWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    using Serializer = std::function<QByteArray()>;
+    using CommitCallback = std::function<void()>;
+
+    explicit StorageWriter(QObject *parent = nullptr);
+    ~StorageWriter();
+
+    // 调度一次整文件写入；debounceMs 内的后续调度会覆盖本次内容
+    void schedule(const QString &path, Serializer serializer, int debounceMs,
+                  CommitCallback onCommitted = CommitCallback());
+
+    // 立即写出所有待写任务，最多等待 timeoutMs；超时后丢弃剩余任务。返回是否全部完成
+    bool flush(int timeoutMs);
+    void stop(int timeoutMs);
+
+signals:
+    void fileWritten(const QString &path);
+    void writeError(const QString &message);
+
+protected:
+    void run() override;
+
+private:
+    struct Job
+    {
+        Serializer serializer;
+        CommitCallback onCommitted;
+        qint64 firstScheduledAt = 0;
+        qint64 dueAt = 0;
+    };
+
+    void commit(const QString &path, const Job &job);
+
+    QMutex m_mutex;
+    QWaitCondition m_wakeup;
+    QWaitCondition m_idle;
+    QElapsedTimer m_clock;
+    QHash<QString, Job> m_pending;
+    bool m_busy;
+    bool m_flushing;
+    bool m_stopping;
+
+    // 持续有新调度时最长推迟时间，避免一直写不出去
+    static const int MAX_DELAY_MS = 5000;
+};
+
+} // namespace WinBrowserQt
+
+#endif // STORAGEWRITER_H
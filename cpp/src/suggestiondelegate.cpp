@@ -0,0 +1,75 @@
+#include "suggestiondelegate.h"
+#include "suggestionlistmodel.h"
+#include <QPainter>
+#include <QApplication>
+#include <QStyle>
+
+namespace WinBrowserQt {
+
+namespace {
+
+const QString &iconFor(SuggestionType type)
+{
+    static const QString search = QStringLiteral("🔍");
+    static const QString url = QStringLiteral("🌐");
+    static const QString history = QStringLiteral("🕐");
+
+    switch (type) {
+    case SuggestionType::Search:
+    case SuggestionType::SearchSuggestion:
+        return search;
+    case SuggestionType::Url:
+        return url;
+    case SuggestionType::History:
+        break;
+    }
+    return history;
+}
+
+} // namespace
+
+SuggestionDelegate::SuggestionDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void SuggestionDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const auto *model = qobject_cast<const SuggestionListModel *>(index.model());
+    if (!model) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+    const SuggestionItem &item = model->at(index.row());
+
+    // 背景（选中、悬停）交给样式绘制，文字自己绘制，超出的部分由矩形裁剪
+    QStyle *style = option.widget ? option.widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, option.widget);
+
+    const bool selected = option.state & QStyle::State_Selected;
+    const QColor textColor = option.palette.color(selected ? QPalette::HighlightedText : QPalette::Text);
+    const QColor urlColor = selected ? textColor : option.palette.color(QPalette::PlaceholderText);
+
+    const QRect content = option.rect.adjusted(PADDING, PADDING / 2, -PADDING, -PADDING / 2);
+    const int lineHeight = content.height() / 2;
+    const QRect iconRect(content.left(), content.top(), ICON_WIDTH, content.height());
+    const QRect titleRect(iconRect.right() + 1, content.top(), content.width() - ICON_WIDTH, lineHeight);
+    const QRect urlRect(titleRect.left(), titleRect.bottom() + 1, titleRect.width(), content.height() - lineHeight);
+
+    painter->save();
+    painter->setFont(option.font);
+    painter->setPen(textColor);
+    painter->drawText(iconRect, Qt::AlignCenter, iconFor(item.type));
+    painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine, item.title);
+    painter->setPen(urlColor);
+    painter->drawText(urlRect, Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine, item.url);
+    painter->restore();
+}
+
+QSize SuggestionDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const
+{
+    // 与内容无关，视图开启 uniformItemSizes 后只计算一次
+    return QSize(option.rect.width(), option.fontMetrics.height() * 2 + PADDING);
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,27 @@
+#ifndef SUGGESTIONDELEGATE_H
+#define SUGGESTIONDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+namespace WinBrowserQt {
+
+// 地址栏建议的绘制：图标、标题和 URL 两行，直接读取 SuggestionListModel 中的建议，
+// 不经过 QVariant，也不逐行拼接字符串；行高固定，视图可以按统一行高布局
+class SuggestionDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit SuggestionDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    static const int PADDING = 4;
+    static const int ICON_WIDTH = 24;
+};
+
+} // namespace WinBrowserQt
+
+#endif // SUGGESTIONDELEGATE_H
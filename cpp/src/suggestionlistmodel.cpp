@@ -0,0 +1,81 @@
+#include "suggestionlistmodel.h"
+
+namespace WinBrowserQt {
+
+SuggestionListModel::SuggestionListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int SuggestionListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_items.size());
+}
+
+QVariant SuggestionListModel::data(const QModelIndex &index, int role) const
+{
+    // 绘制不经过这里（见 SuggestionDelegate），只供辅助功能和提示使用
+    if (!index.isValid() || index.row() >= m_items.size()) {
+        return QVariant();
+    }
+
+    const SuggestionItem &item = m_items[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+        return item.title;
+    case Qt::ToolTipRole:
+    case UrlRole:
+        return item.url;
+    case TypeRole:
+        return int(item.type);
+    default:
+        return QVariant();
+    }
+}
+
+bool SuggestionListModel::setSuggestions(const QList<SuggestionItem> &items)
+{
+    const int oldCount = int(m_items.size());
+    const int newCount = int(items.size());
+
+    int prefix = 0;
+    while (prefix < oldCount && prefix < newCount && m_items[prefix] == items[prefix]) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < oldCount - prefix && suffix < newCount - prefix
+           && m_items[oldCount - 1 - suffix] == items[newCount - 1 - suffix]) {
+        ++suffix;
+    }
+
+    // 中间部分先按较短的一方原位替换，其余的行插入或删除
+    const int oldMiddle = oldCount - prefix - suffix;
+    const int newMiddle = newCount - prefix - suffix;
+    const int replaced = qMin(oldMiddle, newMiddle);
+
+    if (oldMiddle > newMiddle) {
+        beginRemoveRows(QModelIndex(), prefix + replaced, prefix + oldMiddle - 1);
+        m_items.remove(prefix + replaced, oldMiddle - newMiddle);
+        endRemoveRows();
+    } else if (newMiddle > oldMiddle) {
+        beginInsertRows(QModelIndex(), prefix + replaced, prefix + newMiddle - 1);
+        m_items.insert(prefix + replaced, newMiddle - oldMiddle, SuggestionItem());
+        for (int row = prefix + replaced; row < prefix + newMiddle; ++row) {
+            m_items[row] = items[row];
+        }
+        endInsertRows();
+    }
+
+    for (int row = prefix; row < prefix + replaced; ++row) {
+        m_items[row] = items[row];
+    }
+    if (replaced > 0) {
+        emit dataChanged(index(prefix), index(prefix + replaced - 1));
+    }
+
+    // 内容已经相同，改为共享调用方的数组
+    m_items = items;
+    return oldMiddle > 0 || newMiddle > 0;
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,60 @@
+#ifndef SUGGESTIONLISTMODEL_H
+#define SUGGESTIONLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QList>
+
+namespace WinBrowserQt {
+
+enum class SuggestionType {
+    Search,
+    Url,
+    History,
+    SearchSuggestion        // 远程搜索建议
+};
+
+class SuggestionItem
+{
+public:
+    QString title;
+    QString url;
+    SuggestionType type;
+
+    bool operator==(const SuggestionItem &other) const
+    {
+        return type == other.type && url == other.url && title == other.title;
+    }
+    bool operator!=(const SuggestionItem &other) const { return !(*this == other); }
+};
+
+// 地址栏建议列表的模型，行直接对应建议数组中的元素，由 SuggestionDelegate 绘制
+// - setSuggestions 与当前内容比较：去掉相同的前缀和后缀，中间部分原位替换的行发出 dataChanged，
+//   多出或缺少的行发出插入/删除，视图只重绘变化的行；返回是否有行发生变化
+// - 比较完成后直接共享调用方的数组（隐式共享），不逐行复制
+class SuggestionListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Role {
+        UrlRole = Qt::UserRole + 1,
+        TypeRole
+    };
+
+    explicit SuggestionListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    const SuggestionItem &at(int row) const { return m_items[row]; }
+    const QList<SuggestionItem> &suggestions() const { return m_items; }
+    bool setSuggestions(const QList<SuggestionItem> &items);
+
+private:
+    QList<SuggestionItem> m_items;
+};
+
+} // namespace WinBrowserQt
+
+#endif // SUGGESTIONLISTMODEL_H
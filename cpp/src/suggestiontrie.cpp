@@ -0,0 +1,335 @@
+#include "suggestiontrie.h"
+#include <algorithm>
+
+namespace WinBrowserQt {
+
+namespace {
+
+// 去掉协议、用户信息和 "www."，保留原有大小写
+QString stripUrl(const QString &url)
+{
+    QString stripped = url.trimmed();
+    const qsizetype schemeEnd = stripped.indexOf(QLatin1String("://"));
+    if (schemeEnd > 0) {
+        stripped.remove(0, schemeEnd + 3);
+    }
+
+    qsizetype hostEnd = stripped.indexOf('/');
+    if (hostEnd < 0) {
+        hostEnd = stripped.size();
+    }
+    const qsizetype at = QStringView(stripped).left(hostEnd).lastIndexOf('@');
+    if (at >= 0) {
+        stripped.remove(0, at + 1);
+    }
+
+    if (stripped.startsWith(QLatin1String("www."), Qt::CaseInsensitive)) {
+        stripped.remove(0, 4);
+    }
+    return stripped;
+}
+
+} // namespace
+
+SuggestionTrie::SuggestionTrie()
+{
+    clear();
+}
+
+void SuggestionTrie::clear()
+{
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_entries.clear();
+    m_freeEntries.clear();
+    m_entryById.clear();
+    m_nodes.append(Node());
+}
+
+void SuggestionTrie::update(const QString &id, const QString &url, const QString &title, double rank)
+{
+    const QString key = keyFor(url);
+
+    auto it = m_entryById.constFind(id);
+    if (it != m_entryById.constEnd()) {
+        const int entry = it.value();
+        if (m_entries[entry].key == key) {
+            m_entries[entry].url = url;
+            m_entries[entry].title = title;
+            const double oldRank = m_entries[entry].rank;
+            m_entries[entry].rank = rank;
+
+            // 子节点缓存是父节点缓存的子集：条目在某个节点落选或不在缓存中，祖先节点也一样，可以提前结束
+            if (rank > oldRank) {
+                for (int node = m_entries[entry].node; node >= 0 && promote(node, entry);
+                     node = m_nodes[node].parent) {
+                }
+            } else if (rank < oldRank) {
+                for (int node = m_entries[entry].node; node >= 0 && m_nodes[node].top.contains(entry);
+                     node = m_nodes[node].parent) {
+                    recomputeTop(node);
+                }
+            }
+            return;
+        }
+        // 键变化时按删除后重新加入处理
+        remove(id);
+    }
+
+    if (key.isEmpty()) {
+        return;
+    }
+
+    int entry;
+    if (!m_freeEntries.isEmpty()) {
+        entry = m_freeEntries.takeLast();
+    } else {
+        entry = int(m_entries.size());
+        m_entries.append(Entry());
+    }
+    const int node = insertKey(key);
+
+    Entry &inserted = m_entries[entry];
+    inserted.id = id;
+    inserted.url = url;
+    inserted.title = title;
+    inserted.key = key;
+    inserted.rank = rank;
+    inserted.node = node;
+    m_nodes[node].entries.append(entry);
+    m_entryById.insert(id, entry);
+
+    for (int current = node; current >= 0 && promote(current, entry); current = m_nodes[current].parent) {
+    }
+}
+
+void SuggestionTrie::remove(const QString &id)
+{
+    auto it = m_entryById.find(id);
+    if (it == m_entryById.end()) {
+        return;
+    }
+
+    const int entry = it.value();
+    m_entryById.erase(it);
+
+    const int node = m_entries[entry].node;
+    m_nodes[node].entries.removeOne(entry);
+    for (int current = node; current >= 0 && m_nodes[current].top.contains(entry);
+         current = m_nodes[current].parent) {
+        recomputeTop(current);
+    }
+    pruneNode(node);
+
+    m_entries[entry] = Entry();
+    m_freeEntries.append(entry);
+}
+
+QList<SuggestionTrie::Match> SuggestionTrie::complete(const QString &input, int limit) const
+{
+    QList<Match> matches;
+    const QString key = keyFor(input);
+    if (key.isEmpty() || limit <= 0) {
+        return matches;
+    }
+
+    const int node = findNode(key);
+    if (node < 0) {
+        return matches;
+    }
+
+    const QList<int> &top = m_nodes[node].top;
+    const int count = qMin(limit, int(top.size()));
+    matches.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const Entry &entry = m_entries[top[i]];
+        matches.append({entry.url, entry.title});
+    }
+    return matches;
+}
+
+QString SuggestionTrie::inlineCompletion(const QString &input) const
+{
+    // 包含空白的输入是搜索词，不补全
+    if (input.isEmpty() || input.contains(' ') || input.back().isSpace()) {
+        return QString();
+    }
+
+    const QString key = keyFor(input);
+    if (key.isEmpty()) {
+        return QString();
+    }
+    const int node = findNode(key);
+    if (node < 0 || m_nodes[node].top.isEmpty()) {
+        return QString();
+    }
+
+    // 补全的文本取原始 URL，保留路径的大小写；大小写转换改变了长度时退回小写的键
+    const Entry &best = m_entries[m_nodes[node].top.first()];
+    QString source = stripUrl(best.url);
+    if (source.size() != best.key.size()) {
+        source = best.key;
+    }
+
+    const qsizetype slash = source.indexOf('/', key.size());
+    const QString completion = slash < 0 ? source.mid(key.size()) : source.mid(key.size(), slash - key.size() + 1);
+    // 只补一个 '/' 没有意义
+    return completion == QLatin1String("/") ? QString() : completion;
+}
+
+QString SuggestionTrie::keyFor(const QString &url)
+{
+    return stripUrl(url).toLower();
+}
+
+int SuggestionTrie::findNode(const QString &key) const
+{
+    // 输入可以停在某条边的中间，此时边的终点所在子树中的键都以输入为前缀
+    int node = 0;
+    qsizetype pos = 0;
+    while (pos < key.size()) {
+        const int child = childFor(node, key[pos]);
+        if (child < 0) {
+            return -1;
+        }
+        const QString &label = m_nodes[child].label;
+        const qsizetype length = qMin(label.size(), key.size() - pos);
+        if (QStringView(label).left(length) != QStringView(key).mid(pos, length)) {
+            return -1;
+        }
+        pos += length;
+        node = child;
+    }
+    return node;
+}
+
+int SuggestionTrie::insertKey(const QString &key)
+{
+    int node = 0;
+    qsizetype pos = 0;
+    while (pos < key.size()) {
+        int child = childFor(node, key[pos]);
+        if (child < 0) {
+            child = newNode(key.mid(pos), node);
+            m_nodes[node].children.append(child);
+            return child;
+        }
+
+        const QString label = m_nodes[child].label;
+        qsizetype common = 1;
+        while (common < label.size() && pos + common < key.size() && label[common] == key[pos + common]) {
+            ++common;
+        }
+
+        if (common < label.size()) {
+            // 在公共前缀处拆分边：中间节点的子树与原子节点相同，缓存直接复制
+            const int middle = newNode(label.left(common), node);
+            m_nodes[middle].children.append(child);
+            m_nodes[middle].top = m_nodes[child].top;
+            m_nodes[child].label = label.mid(common);
+            m_nodes[child].parent = middle;
+            QList<int> &siblings = m_nodes[node].children;
+            siblings[siblings.indexOf(child)] = middle;
+            child = middle;
+        }
+
+        node = child;
+        pos += common;
+    }
+    return node;
+}
+
+int SuggestionTrie::childFor(int node, QChar first) const
+{
+    for (int child : m_nodes[node].children) {
+        if (m_nodes[child].label.front() == first) {
+            return child;
+        }
+    }
+    return -1;
+}
+
+int SuggestionTrie::newNode(const QString &label, int parent)
+{
+    int node;
+    if (!m_freeNodes.isEmpty()) {
+        node = m_freeNodes.takeLast();
+    } else {
+        node = int(m_nodes.size());
+        m_nodes.append(Node());
+    }
+    m_nodes[node].label = label;
+    m_nodes[node].parent = parent;
+    return node;
+}
+
+void SuggestionTrie::pruneNode(int node)
+{
+    while (node > 0 && m_nodes[node].entries.isEmpty() && m_nodes[node].children.size() <= 1) {
+        const int parent = m_nodes[node].parent;
+        QList<int> &siblings = m_nodes[parent].children;
+        const qsizetype index = siblings.indexOf(node);
+
+        if (m_nodes[node].children.isEmpty()) {
+            // 空叶子直接删除，父节点可能随之只剩一个子节点，继续向上检查
+            siblings.remove(index);
+            m_nodes[node] = Node();
+            m_freeNodes.append(node);
+            node = parent;
+            continue;
+        }
+
+        // 只有一个子节点且自身没有条目：与子节点合并为一条边，子树不变，缓存仍然有效
+        const int child = m_nodes[node].children.first();
+        m_nodes[child].label.prepend(m_nodes[node].label);
+        m_nodes[child].parent = parent;
+        siblings[index] = child;
+        m_nodes[node] = Node();
+        m_freeNodes.append(node);
+        break;
+    }
+}
+
+bool SuggestionTrie::promote(int node, int entry)
+{
+    QList<int> &top = m_nodes[node].top;
+    top.removeOne(entry);
+    if (top.size() >= TOP_K && !isBetter(entry, top.last())) {
+        return false;
+    }
+
+    const auto pos = std::lower_bound(top.begin(), top.end(), entry,
+                                      [this](int a, int b) { return isBetter(a, b); });
+    top.insert(pos - top.begin(), entry);
+    if (top.size() > TOP_K) {
+        top.removeLast();
+    }
+    return true;
+}
+
+void SuggestionTrie::recomputeTop(int node)
+{
+    // 子节点的缓存已经是各自子树的前 TOP_K 个，合并它们和本节点的条目即可
+    QList<int> candidates = m_nodes[node].entries;
+    for (int child : std::as_const(m_nodes[node].children)) {
+        candidates.append(m_nodes[child].top);
+    }
+
+    auto better = [this](int a, int b) { return isBetter(a, b); };
+    if (candidates.size() > TOP_K) {
+        std::partial_sort(candidates.begin(), candidates.begin() + TOP_K, candidates.end(), better);
+        candidates.resize(TOP_K);
+    } else {
+        std::sort(candidates.begin(), candidates.end(), better);
+    }
+    m_nodes[node].top = candidates;
+}
+
+bool SuggestionTrie::isBetter(int a, int b) const
+{
+    const double rankA = m_entries[a].rank;
+    const double rankB = m_entries[b].rank;
+    return rankA > rankB || (rankA == rankB && a < b);
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,86 @@
+#ifndef SUGGESTIONTRIE_H
+#define SUGGESTIONTRIE_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+
+namespace WinBrowserQt {
+
+// 地址栏前缀补全用的压缩前缀树（radix trie），条目来自历史记录和书签
+// - 键是去掉协议和 "www." 后小写的 URL（主机在前），输入按同样的规则处理后做前缀匹配
+// - 每个节点缓存子树中排序键最大的 TOP_K 个条目，查询只需沿输入下降，与条目总数无关：O(输入长度 + k)
+// - 条目的排序键上升（新的访问）时沿路径把它插入各节点的缓存；下降或删除时自底向上重算包含它的节点
+// - 同一个键可以对应多个条目（http 与 https），条目按调用方提供的 id 区分
+// 只应在界面线程使用
+class SuggestionTrie
+{
+public:
+    struct Match
+    {
+        QString url;
+        QString title;
+    };
+
+    static const int TOP_K = 16;
+
+    SuggestionTrie();
+
+    void clear();
+    // 新增或更新条目；id 相同时按新的 URL、标题和排序键替换
+    void update(const QString &id, const QString &url, const QString &title, double rank);
+    void remove(const QString &id);
+    bool contains(const QString &id) const { return m_entryById.contains(id); }
+
+    int size() const { return int(m_entryById.size()); }
+
+    // 键以输入为前缀的条目，按排序键从大到小，最多 qMin(limit, TOP_K) 个
+    QList<Match> complete(const QString &input, int limit) const;
+    // 内联补全：排序键最大的匹配条目从输入末尾补到下一个 '/'（输入还在主机部分时即补全主机），
+    // 返回需要追加在输入之后的文本，没有可补全的内容时为空
+    QString inlineCompletion(const QString &input) const;
+
+    // 去掉协议、用户信息和 "www." 并转为小写
+    static QString keyFor(const QString &url);
+
+private:
+    struct Node
+    {
+        QString label;          // 从父节点到这里的边
+        int parent = -1;
+        QList<int> children;
+        QList<int> entries;     // 键恰好在此结束的条目
+        QList<int> top;         // 子树中排序键最大的条目，从大到小
+    };
+
+    struct Entry
+    {
+        QString id;
+        QString url;
+        QString title;
+        QString key;
+        double rank = 0;
+        int node = -1;
+    };
+
+    int findNode(const QString &key) const;
+    int insertKey(const QString &key);
+    int childFor(int node, QChar first) const;
+    int newNode(const QString &label, int parent);
+    // 删除没有条目的叶子，合并只有一个子节点的节点
+    void pruneNode(int node);
+    // 把排序键上升的条目放入节点的缓存；未能进入时返回 false
+    bool promote(int node, int entry);
+    void recomputeTop(int node);
+    bool isBetter(int a, int b) const;
+
+    QList<Node> m_nodes;            // 下标 0 是根节点
+    QList<int> m_freeNodes;
+    QList<Entry> m_entries;
+    QList<int> m_freeEntries;
+    QHash<QString, int> m_entryById;
+};
+
+} // namespace WinBrowserQt
+
+#endif // SUGGESTIONTRIE_H
@@ -0,0 +1,231 @@
+#include "textmatcher.h"
+#include <QChar>
+#include <QtAlgorithms>
+#include <bitset>
+
+#if defined(Q_PROCESSOR_X86)
+#  include <immintrin.h>
+#  if defined(Q_CC_MSVC)
+#    include <intrin.h>
+#    define WINBROWSER_TARGET_AVX2
+#  else
+#    define WINBROWSER_TARGET_AVX2 __attribute__((target("avx2")))
+#  endif
+#  define WINBROWSER_X86_SIMD
+#endif
+
+namespace WinBrowserQt {
+
+namespace {
+
+using Kernel = bool (*)(const char16_t *haystack, qsizetype size, const char16_t *needle, qsizetype length);
+
+inline char16_t foldChar(char16_t c)
+{
+    if (c < 0x80) {
+        return (c >= 'A' && c <= 'Z') ? char16_t(c + 0x20) : c;
+    }
+    return char16_t(QChar::toCaseFolded(char32_t(c)));
+}
+
+inline bool equalsFolded(const char16_t *haystack, const char16_t *needle, qsizetype length)
+{
+    for (qsizetype k = 0; k < length; ++k) {
+        if (foldChar(haystack[k]) != needle[k]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 向量比较时会折叠的码元：ASCII 大写字母、开尔文符号 U+212A 和长 s U+017F
+inline bool isFoldedInVector(char16_t c)
+{
+    return (c >= 'A' && c <= 'Z') || c == 0x212A || c == 0x017F;
+}
+
+// 折叠后的查询字符只有在不存在其他码元（向量中不折叠的）折叠到它时，才能用向量原样比较筛选。
+// 只看字符本身有没有大小写映射不够：'ß' 没有简单大小写映射，但 U+1E9E 'ẞ' 折叠为 'ß'
+bool isFilterSafe(char16_t c)
+{
+    static const std::bitset<0x10000> foldTargets = [] {
+        std::bitset<0x10000> targets;
+        for (char32_t u = 0; u < 0x10000; ++u) {
+            const char16_t folded = foldChar(char16_t(u));
+            if (folded != u && !isFoldedInVector(char16_t(u))) {
+                targets.set(folded);
+            }
+        }
+        return targets;
+    }();
+    return !foldTargets.test(c);
+}
+
+bool findScalar(const char16_t *haystack, qsizetype size, const char16_t *needle, qsizetype length)
+{
+    for (qsizetype i = 0; i + length <= size; ++i) {
+        if (foldChar(haystack[i]) == needle[0] && equalsFolded(haystack + i, needle, length)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef WINBROWSER_X86_SIMD
+
+// 向量中只折叠 ASCII 大写字母，以及简单折叠后落到 ASCII 的两个字符：开尔文符号 U+212A 和长 s U+017F
+inline __m128i foldAscii(__m128i v)
+{
+    const __m128i offset = _mm_sub_epi16(v, _mm_set1_epi16('A'));
+    const __m128i upper = _mm_cmpeq_epi16(_mm_subs_epu16(offset, _mm_set1_epi16(25)), _mm_setzero_si128());
+    v = _mm_add_epi16(v, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+
+    const __m128i kelvin = _mm_cmpeq_epi16(v, _mm_set1_epi16(short(0x212A)));
+    const __m128i longS = _mm_cmpeq_epi16(v, _mm_set1_epi16(short(0x017F)));
+    v = _mm_or_si128(_mm_andnot_si128(kelvin, v), _mm_and_si128(kelvin, _mm_set1_epi16('k')));
+    return _mm_or_si128(_mm_andnot_si128(longS, v), _mm_and_si128(longS, _mm_set1_epi16('s')));
+}
+
+bool findSse2(const char16_t *haystack, qsizetype size, const char16_t *needle, qsizetype length)
+{
+    // 每次比较 8 个起始位置：首字符和尾字符都相同的位置才逐字符核对
+    const __m128i first = _mm_set1_epi16(short(needle[0]));
+    const __m128i last = _mm_set1_epi16(short(needle[length - 1]));
+
+    qsizetype i = 0;
+    for (; i + length - 1 + 8 <= size; i += 8) {
+        const __m128i head = foldAscii(_mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i)));
+        const __m128i tail = foldAscii(_mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i + length - 1)));
+        uint mask = uint(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(head, first),
+                                                         _mm_cmpeq_epi16(tail, last))));
+        while (mask) {
+            // 每个 16 位通道在掩码中占两位
+            const uint lane = qCountTrailingZeroBits(mask) / 2;
+            if (equalsFolded(haystack + i + lane, needle, length)) {
+                return true;
+            }
+            mask &= ~(3u << (lane * 2));
+        }
+    }
+    return findScalar(haystack + i, size - i, needle, length);
+}
+
+WINBROWSER_TARGET_AVX2 inline __m256i foldAscii256(__m256i v)
+{
+    const __m256i offset = _mm256_sub_epi16(v, _mm256_set1_epi16('A'));
+    const __m256i upper = _mm256_cmpeq_epi16(_mm256_subs_epu16(offset, _mm256_set1_epi16(25)), _mm256_setzero_si256());
+    v = _mm256_add_epi16(v, _mm256_and_si256(upper, _mm256_set1_epi16(0x20)));
+
+    const __m256i kelvin = _mm256_cmpeq_epi16(v, _mm256_set1_epi16(short(0x212A)));
+    const __m256i longS = _mm256_cmpeq_epi16(v, _mm256_set1_epi16(short(0x017F)));
+    v = _mm256_blendv_epi8(v, _mm256_set1_epi16('k'), kelvin);
+    return _mm256_blendv_epi8(v, _mm256_set1_epi16('s'), longS);
+}
+
+WINBROWSER_TARGET_AVX2 bool findAvx2(const char16_t *haystack, qsizetype size, const char16_t *needle, qsizetype length)
+{
+    const __m256i first = _mm256_set1_epi16(short(needle[0]));
+    const __m256i last = _mm256_set1_epi16(short(needle[length - 1]));
+
+    qsizetype i = 0;
+    for (; i + length - 1 + 16 <= size; i += 16) {
+        const __m256i head = foldAscii256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i)));
+        const __m256i tail = foldAscii256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i + length - 1)));
+        uint mask = uint(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi16(head, first),
+                                                               _mm256_cmpeq_epi16(tail, last))));
+        while (mask) {
+            const uint lane = qCountTrailingZeroBits(mask) / 2;
+            if (equalsFolded(haystack + i + lane, needle, length)) {
+                return true;
+            }
+            mask &= ~(3u << (lane * 2));
+        }
+    }
+    // 剩余不足 16 个起始位置时交给 SSE2 处理
+    return findSse2(haystack + i, size - i, needle, length);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(Q_CC_MSVC)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // 还要确认操作系统保存 YMM 寄存器
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // WINBROWSER_X86_SIMD
+
+struct KernelChoice
+{
+    Kernel kernel;
+    const char *name;
+};
+
+KernelChoice selectKernel()
+{
+#ifdef WINBROWSER_X86_SIMD
+    if (cpuHasAvx2()) {
+        return {findAvx2, "avx2"};
+    }
+    return {findSse2, "sse2"};
+#else
+    return {findScalar, "scalar"};
+#endif
+}
+
+const KernelChoice &kernelChoice()
+{
+    static const KernelChoice choice = selectKernel();
+    return choice;
+}
+
+} // namespace
+
+TextMatcher::TextMatcher(QStringView needle)
+    : m_vectorizable(false)
+{
+    m_folded.reserve(needle.size());
+    for (QChar c : needle) {
+        m_folded.append(foldChar(c.unicode()));
+    }
+    if (!m_folded.isEmpty()) {
+        m_vectorizable = isFilterSafe(m_folded.first()) && isFilterSafe(m_folded.last());
+    }
+}
+
+bool TextMatcher::matches(QStringView haystack) const
+{
+    const qsizetype length = m_folded.size();
+    if (length == 0) {
+        return true;
+    }
+    if (haystack.size() < length) {
+        return false;
+    }
+
+    // 首尾字符有大小写变体（如 é）时向量筛选可能漏掉，改用标量实现
+    const Kernel kernel = m_vectorizable ? kernelChoice().kernel : findScalar;
+    return kernel(haystack.utf16(), haystack.size(), m_folded.constData(), length);
+}
+
+const char *TextMatcher::kernelName()
+{
+    return kernelChoice().name;
+}
+
+} // namespace WinBrowserQt
@@ -0,0 +1,33 @@
+#ifndef TEXTMATCHER_H
+#define TEXTMATCHER_H
+
+#include <QString>
+#include <QStringView>
+#include <QVarLengthArray>
+
+namespace WinBrowserQt {
+
+// 不区分大小写的 UTF-16 子串匹配，匹配过程不分配内存
+// 构造时把查询串按大小写折叠一次；匹配时先用 SIMD 比较首尾字符筛出候选位置（AVX2 或 SSE2，
+// 运行时按 CPU 选择，其他平台为标量实现），再逐字符核对
+// 折叠规则与 Qt::CaseInsensitive 相同（简单大小写折叠），但只按 UTF-16 码元折叠，不处理辅助平面字符的大小写
+class TextMatcher
+{
+public:
+    explicit TextMatcher(QStringView needle);
+
+    bool isEmpty() const { return m_folded.isEmpty(); }
+    // 空查询串总是匹配
+    bool matches(QStringView haystack) const;
+
+    // 当前 CPU 上选用的实现："avx2"、"sse2" 或 "scalar"
+    static const char *kernelName();
+
+private:
+    QVarLengthArray<char16_t, 64> m_folded;
+    bool m_vectorizable;    // 首尾字符可以用向量比较筛选
+};
+
+} // namespace WinBrowserQt
+
+#endif // TEXTMATCHER_H
@@ -0,0 +1,272 @@
+// RemoteSuggestionProvider 的测试
+// 端点指向本机的 HTTP 替身：QTcpServer 按请求行解析出输入，延迟一段时间后返回 OpenSearch 建议格式，
+// 每个响应都关闭连接，服务端记录的请求数就是提供者发出的请求数；连接在响应前断开说明请求被中止
+
+#include "remotesuggestionprovider.h"
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QUrlQuery>
+#include <QPointer>
+#include <QTimer>
+#include <QHash>
+
+using namespace WinBrowserQt;
+
+namespace {
+
+class SuggestServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SuggestServer(QObject *parent = nullptr) : QObject(parent)
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, &SuggestServer::onNewConnection);
+    }
+
+    bool listen() { return m_server.listen(QHostAddress::LocalHost); }
+    QString endpoint() const
+    {
+        return QString("http://127.0.0.1:%1/suggest?q={searchTerms}").arg(m_server.serverPort());
+    }
+
+    // 每个请求在响应前等待的时间
+    void setLatency(int msecs) { m_latencyMs = msecs; }
+    // 指定输入的建议，未指定时返回 "<输入> 1"、"<输入> 2"
+    void setSuggestions(const QString &query, const QStringList &suggestions) { m_suggestions.insert(query, suggestions); }
+
+    QStringList queries() const { return m_queries; }
+    // 响应前客户端已断开的请求数
+    int dropped() const { return m_dropped; }
+
+private:
+    void onNewConnection()
+    {
+        while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        }
+    }
+
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray &buffer = m_buffers[socket];
+        buffer.append(socket->readAll());
+        if (!buffer.contains("\r\n\r\n")) {
+            return;
+        }
+
+        // GET /suggest?q=... HTTP/1.1
+        const QByteArray target = buffer.left(buffer.indexOf("\r\n")).split(' ').value(1);
+        m_buffers.remove(socket);
+        const QString query = QUrlQuery(QUrl(QString::fromUtf8(target)).query())
+                                  .queryItemValue("q", QUrl::FullyDecoded);
+        m_queries.append(query);
+
+        QPointer<QTcpSocket> guard(socket);
+        QTimer::singleShot(m_latencyMs, this, [this, guard, query]() {
+            if (!guard || guard->state() != QAbstractSocket::ConnectedState) {
+                ++m_dropped;
+                return;
+            }
+            respond(guard, query);
+        });
+    }
+
+    void respond(QTcpSocket *socket, const QString &query)
+    {
+        const QStringList suggestions = m_suggestions.value(query, { query + " 1", query + " 2" });
+        const QByteArray body = QJsonDocument(QJsonArray{ query, QJsonArray::fromStringList(suggestions) })
+                                    .toJson(QJsonDocument::Compact);
+        QByteArray response = "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: application/json; charset=utf-8\r\n"
+                              "Connection: close\r\n"
+                              "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n";
+        response.append(body);
+        socket->write(response);
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer m_server;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+    QHash<QString, QStringList> m_suggestions;
+    QStringList m_queries;
+    int m_latencyMs = 50;
+    int m_dropped = 0;
+};
+
+} // namespace
+
+class RemoteSuggestionProviderTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void parsesOpenSearchResponse();
+    void disabledWithoutEndpoint();
+    void servesRepeatedQueryFromCache();
+    void emitsProvisionalFromShorterPrefix();
+    void coalescesSameNormalizedPrefix();
+    void abortsSupersededRequest();
+    void dropsTimedOutRequest();
+
+private:
+    QNetworkAccessManager *m_network = nullptr;
+    SuggestServer *m_server = nullptr;
+    RemoteSuggestionProvider *m_provider = nullptr;
+};
+
+void RemoteSuggestionProviderTest::init()
+{
+    m_network = new QNetworkAccessManager(this);
+    // 不经过环境变量里的代理，请求直接到达替身
+    m_network->setProxy(QNetworkProxy::NoProxy);
+    m_server = new SuggestServer(this);
+    QVERIFY(m_server->listen());
+    m_provider = new RemoteSuggestionProvider(m_network, this);
+    m_provider->setEndpoint(m_server->endpoint());
+}
+
+void RemoteSuggestionProviderTest::cleanup()
+{
+    delete m_provider;
+    delete m_server;
+    delete m_network;
+}
+
+void RemoteSuggestionProviderTest::parsesOpenSearchResponse()
+{
+    QCOMPARE(RemoteSuggestionProvider::parseResponse(R"(["qt", ["qt", " qt creator ", "", 3]])"),
+             QStringList({ "qt", "qt creator" }));
+    QVERIFY(RemoteSuggestionProvider::parseResponse("not json").isEmpty());
+
+    QJsonArray many;
+    for (int i = 0; i < RemoteSuggestionProvider::MAX_SUGGESTIONS + 5; ++i) {
+        many.append(QString("s%1").arg(i));
+    }
+    const QByteArray data = QJsonDocument(QJsonArray{ "s", many }).toJson();
+    QCOMPARE(RemoteSuggestionProvider::parseResponse(data).size(), int(RemoteSuggestionProvider::MAX_SUGGESTIONS));
+
+    QCOMPARE(RemoteSuggestionProvider::normalizeQuery("  Qt   Creator "), QString("qt creator"));
+}
+
+void RemoteSuggestionProviderTest::disabledWithoutEndpoint()
+{
+    QSignalSpy spy(m_provider, &RemoteSuggestionProvider::suggestionsReady);
+    m_provider->setEndpoint(QString());
+    QVERIFY(!m_provider->isEnabled());
+
+    m_provider->request("qt");
+    QTest::qWait(200);
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(m_server->queries().isEmpty());
+}
+
+void RemoteSuggestionProviderTest::servesRepeatedQueryFromCache()
+{
+    QSignalSpy spy(m_provider, &RemoteSuggestionProvider::suggestionsReady);
+    m_provider->request("qt");
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(1).toStringList(), QStringList({ "qt 1", "qt 2" }));
+    QCOMPARE(spy.at(0).at(2).toBool(), false);
+
+    // 缓存命中在调用中直接发出，不再访问服务端
+    m_provider->request("QT ");
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).toString(), QString("QT "));
+    QCOMPARE(spy.at(1).at(1).toStringList(), QStringList({ "qt 1", "qt 2" }));
+    QCOMPARE(m_server->queries(), QStringList({ "qt" }));
+
+    m_provider->clearCache();
+    m_provider->request("qt");
+    QTRY_COMPARE(spy.count(), 3);
+    QCOMPARE(m_server->queries(), QStringList({ "qt", "qt" }));
+}
+
+void RemoteSuggestionProviderTest::emitsProvisionalFromShorterPrefix()
+{
+    m_server->setSuggestions("q", { "qt", "Qt Creator", "quora" });
+    QSignalSpy spy(m_provider, &RemoteSuggestionProvider::suggestionsReady);
+    m_provider->request("q");
+    QTRY_COMPARE(spy.count(), 1);
+
+    // 更短前缀的缓存中仍然匹配的建议先作为临时结果发出
+    m_provider->request("qt");
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(1).toStringList(), QStringList({ "qt", "Qt Creator" }));
+    QCOMPARE(spy.at(1).at(2).toBool(), true);
+
+    QTRY_COMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(2).at(1).toStringList(), QStringList({ "qt 1", "qt 2" }));
+    QCOMPARE(spy.at(2).at(2).toBool(), false);
+}
+
+void RemoteSuggestionProviderTest::coalescesSameNormalizedPrefix()
+{
+    m_server->setLatency(200);
+    QSignalSpy spy(m_provider, &RemoteSuggestionProvider::suggestionsReady);
+    m_provider->request("Qt");
+    m_provider->request("qt ");
+    m_provider->request(" QT");
+
+    // 三次输入规范化后相同，只发出一个请求，结果按最新的输入发出一次
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toString(), QString(" QT"));
+    QTest::qWait(300);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(m_server->queries(), QStringList({ "qt" }));
+    QCOMPARE(m_server->dropped(), 0);
+}
+
+void RemoteSuggestionProviderTest::abortsSupersededRequest()
+{
+    m_server->setLatency(300);
+    QSignalSpy spy(m_provider, &RemoteSuggestionProvider::suggestionsReady);
+    m_provider->request("qt");
+    // 等旧请求到达服务端再换输入，确认中止的是已经发出的请求
+    QTRY_COMPARE(m_server->queries().size(), 1);
+    m_provider->request("qtc");
+
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toString(), QString("qtc"));
+    QCOMPARE(spy.at(0).at(1).toStringList(), QStringList({ "qtc 1", "qtc 2" }));
+    QCOMPARE(m_server->queries(), QStringList({ "qt", "qtc" }));
+    QTRY_COMPARE(m_server->dropped(), 1);
+    QCOMPARE(spy.count(), 1);
+
+    // 被中止的结果没有进入缓存
+    m_server->setLatency(0);
+    m_provider->request("qt");
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(m_server->queries().size(), 3);
+
+    // cancel() 中止进行中的请求，之后不再发出
+    m_server->setLatency(300);
+    m_provider->request("qtw");
+    QTRY_COMPARE(m_server->queries().size(), 4);
+    m_provider->cancel();
+    QTRY_COMPARE(m_server->dropped(), 2);
+    QCOMPARE(spy.count(), 2);
+}
+
+void RemoteSuggestionProviderTest::dropsTimedOutRequest()
+{
+    m_server->setLatency(1000);
+    m_provider->setTimeout(100);
+    QSignalSpy spy(m_provider, &RemoteSuggestionProvider::suggestionsReady);
+    m_provider->request("qt");
+
+    QTRY_COMPARE_WITH_TIMEOUT(m_server->dropped(), 1, 3000);
+    QCOMPARE(spy.count(), 0);
+}
+
+QTEST_GUILESS_MAIN(RemoteSuggestionProviderTest)
+#include "remotesuggestionprovider_test.moc"